@@ -0,0 +1,186 @@
+// Compares the bucket occupancy and depth of the IHT under each hash policy, for a few key distributions, with doubling and with constant growth.
+// The IHT's shape only depends on which bucket each key picks at each level, so it is rebuilt in local memory without RDMA.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "rome/logging/logging.h"
+#include "common.h"
+#include "structures/hash_policy.h"
+
+/// @brief A plist of the model. Buckets are created on first use, so a deep plist doesn't take up its full size
+struct Node {
+    struct bucket_t {
+        std::vector<uint64_t> elist; // Hashes of the keys in the bucket's elist
+        std::unique_ptr<Node> child; // The sub-plist, once the bucket was rehashed
+    };
+    std::unordered_map<uint64_t, bucket_t> buckets;
+};
+
+struct Shape {
+    std::vector<size_t> root_occupancy; // Keys under each bucket of the root
+    std::map<size_t, size_t> key_depths; // Depth of the plist holding a key => number of keys
+    size_t plists = 0;
+    size_t plist_bytes = 0;
+    size_t elists = 0;
+    double ns_per_descent = 0; // Time spent picking the buckets of one key's path
+};
+
+// Plists deeper than this aren't made. Their elists grow instead, like the chains of RdmaIHT past its max depth.
+// Keys that a policy never separates pile up there, instead of being split forever
+static const size_t MODEL_MAX_DEPTH = 40;
+
+template <typename Hash>
+class Model {
+    Hash hasher_;
+    Growth growth_;
+    Node root_;
+    Shape shape_;
+
+    /// @brief The buckets of a sub-plist, like RdmaIHT::child_count
+    size_t child_count(size_t count){
+        switch (growth_){
+        case Growth::CONSTANT:
+            return CNF_PLIST_SIZE;
+        case Growth::CAPPED:
+            return std::min(count * 2, (size_t) CNF_PLIST_SIZE * CNF_GROWTH_CAP);
+        default:
+            return count * 2;
+        }
+    }
+
+    void insert(Node* n, uint64_t hash, size_t depth, size_t count){
+        while (true){
+            Node::bucket_t& b = n->buckets[hasher_.bucket(hash, depth, count)];
+            if (b.child == nullptr && (b.elist.size() < CNF_ELIST_SIZE || depth == MODEL_MAX_DEPTH)){
+                b.elist.push_back(hash);
+                return;
+            }
+            if (b.child == nullptr){
+                // Rehash the full elist into a sub-plist, like RdmaIHT::rehash
+                b.child = std::make_unique<Node>();
+                shape_.plists++;
+                shape_.plist_bytes += sizeof(uint64_t) * child_count(count);
+                for (uint64_t h : b.elist) insert(b.child.get(), h, depth + 1, child_count(count));
+                b.elist.clear();
+            }
+            // Continue in the sub-plist
+            n = b.child.get();
+            depth++;
+            count = child_count(count);
+        }
+    }
+
+    /// @brief Walk the plists to count the keys and elists
+    size_t measure(const Node& n, size_t depth){
+        size_t keys = 0;
+        for (auto& [i, b] : n.buckets){
+            if (b.child != nullptr){
+                keys += measure(*b.child, depth + 1);
+            } else if (!b.elist.empty()){
+                shape_.elists++;
+                shape_.key_depths[depth] += b.elist.size();
+                keys += b.elist.size();
+            }
+        }
+        return keys;
+    }
+
+public:
+    Model(Growth growth) : growth_(growth) {}
+
+    Shape build(const std::vector<int>& keys){
+        shape_.plists = 1;
+        shape_.plist_bytes = sizeof(uint64_t) * CNF_PLIST_SIZE;
+        for (int k : keys) insert(&root_, hasher_.hash(k), 1, CNF_PLIST_SIZE);
+        shape_.root_occupancy.assign(CNF_PLIST_SIZE, 0);
+        for (auto& [i, b] : root_.buckets){
+            shape_.root_occupancy[i] = b.child != nullptr ? measure(*b.child, 2) : b.elist.size();
+        }
+        shape_.key_depths.clear();
+        shape_.elists = 0;
+        measure(root_, 1);
+
+        // Time the bucket computations of every key's path, the part of a descent that is the policy's cost
+        uint64_t sum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int k : keys){
+            uint64_t hash = hasher_.hash(k);
+            size_t count = CNF_PLIST_SIZE;
+            for (size_t depth = 1; depth <= shape_.key_depths.rbegin()->first; depth++, count = child_count(count)) sum += hasher_.bucket(hash, depth, count);
+        }
+        auto end = std::chrono::steady_clock::now();
+        // Stored once so the loop isn't optimized away
+        volatile uint64_t sink = sum;
+        (void) sink;
+        shape_.ns_per_descent = std::chrono::duration<double, std::nano>(end - start).count() / keys.size();
+        return shape_;
+    }
+};
+
+void report(const char* policy, const Shape& s, size_t key_count){
+    double mean = (double) key_count / CNF_PLIST_SIZE;
+    double var = 0;
+    size_t max = 0, empty = 0;
+    for (size_t o : s.root_occupancy){
+        var += (o - mean) * (o - mean);
+        if (o > max) max = o;
+        if (o == 0) empty++;
+    }
+    double stddev = std::sqrt(var / CNF_PLIST_SIZE);
+    printf("  %-16s root max/mean %6.2f  cv %5.2f  empty %3zu  plists %6zu (%8zu B)  elists %7zu (%.2f keys each)  %.1f ns/descent\n",
+        policy, max / mean, stddev / mean, empty, s.plists, s.plist_bytes, s.elists, (double) key_count / s.elists, s.ns_per_descent);
+    printf("  %-16s depth:", "");
+    for (auto& [depth, keys] : s.key_depths) printf(" %zu=%.1f%%", depth, 100.0 * keys / key_count);
+    printf("\n");
+}
+
+int main(int argc, char** argv){
+    size_t key_count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    std::mt19937_64 gen(1);
+    std::map<std::string, std::vector<int>> distributions;
+    {
+        std::vector<int>& keys = distributions["uniform"];
+        std::unordered_set<int> seen;
+        std::uniform_int_distribution<int> dist(0, 1 << 30);
+        while (keys.size() < key_count){
+            int k = dist(gen);
+            if (seen.insert(k).second) keys.push_back(k);
+        }
+    }
+    {
+        // A dense range, like the benchmark's key_lb..key_ub
+        std::vector<int>& keys = distributions["sequential"];
+        for (size_t i = 0; i < key_count; i++) keys.push_back(i);
+    }
+    {
+        // Keys that are all the same modulo the root's divisor
+        std::vector<int>& keys = distributions["strided"];
+        for (size_t i = 0; i < key_count; i++) keys.push_back(i * (CNF_PLIST_SIZE - 1));
+    }
+
+    printf("%zu keys, ELIST_SIZE %d, PLIST_SIZE %d\n", key_count, CNF_ELIST_SIZE, CNF_PLIST_SIZE);
+    for (auto& [name, keys] : distributions){
+        printf("%s\n", name.c_str());
+        report("modulo", Model<ModuloLevelHash<int>>(Growth::DOUBLING).build(keys), keys.size());
+        report("mixed", Model<MixedLevelHash<int>>(Growth::DOUBLING).build(keys), keys.size());
+    }
+    // Every plist has PLIST_SIZE buckets, so only a policy that remixes each level separates the keys of a full elist.
+    // RdmaIHT rejects constant and capped growth under the others; modulo is shown for how deep its keys would go
+    printf("constant growth\n");
+    for (auto& [name, keys] : distributions){
+        printf("%s\n", name.c_str());
+        report("modulo", Model<ModuloLevelHash<int>>(Growth::CONSTANT).build(keys), keys.size());
+        report("mixed", Model<MixedLevelHash<int>>(Growth::CONSTANT).build(keys), keys.size());
+    }
+    return 0;
+}
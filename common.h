@@ -5,12 +5,36 @@
 #define REMOVE 2
 #define CNF_ELIST_SIZE 7 // 7
 #define CNF_PLIST_SIZE 128 // 128
+#define CNF_BUCKET_PAIRS 0 // Pairs a bucket holds itself before they spill to an EList. 0 keeps buckets a single word
+#define CNF_SPLIT_WAIT_NS 200000 // How long a split shipped to the owner of the elist waits to be taken before the inserter does it itself
+#define CNF_STOCK_SIZE 16 // Objects of each size a peer keeps ready for the others to place in its pool
+#define CNF_STOCK_PLISTS 3 // Sizes of plist kept in stock (1, 2 and 4 times PLIST_SIZE). Larger plists stay with the peer that makes them
+#define CNF_PLACEMENT_REFRESH 64 // Placements between reads of which peers keep a stock and how loaded they are
+#define CNF_ROOT_MAX_FACTOR 65536 // The most times PLIST_SIZE buckets the root is given for the expected number of keys. A power of two
+#define CNF_GROWTH_CAP 8 // The most times PLIST_SIZE buckets a plist gets under capped doubling. A power of two
+#define CNF_RECLAIM_PERIOD 256 // Operations a thread does between attempts to advance the reclamation epoch
+#define CNF_BACKOFF_MIN_NS 128 // First wait of the backoff lock strategy
+#define CNF_BACKOFF_MAX_NS 16384 // Bound on the wait of the backoff lock strategy
+#define CNF_COHORT_PASSES 8 // Times in a row a remote lock can be passed between the threads of a node before it is released
 
 #include "tcp.h"
+#include "rome/rdma/memory_pool/remote_ptr.h"
 
 /// @brief a type used for templating remote pointers as anonymous (for exchanging over the network where the types are "lost")
 struct anon_ptr {};
 
+/// @brief Pack a remote pointer into a single word, so it can be written or CAS-ed with RDMA and shared between threads
+template <typename T>
+inline uint64_t pack_ptr(rome::rdma::remote_ptr<T> ptr){
+    return (ptr.id() << 48) | ptr.address();
+}
+
+/// @brief The reverse of pack_ptr
+template <typename T>
+inline rome::rdma::remote_ptr<T> unpack_ptr(uint64_t packed){
+    return rome::rdma::remote_ptr<T>(packed >> 48, packed & ((1ull << 48) - 1));
+}
+
 /// @brief IHT_Op is used by the Client Adaptor to pass in operations to Apply, by forming a stream of IHT_Ops.
 template <typename K, typename V>
 struct IHT_Op {
@@ -20,6 +44,113 @@ struct IHT_Op {
     IHT_Op(int op_type_, K key_, V value_) : op_type(op_type_), key(key_), value(value_) {};
 };
 
+/// @brief How a thread waits for a remote lock that someone else holds. Every peer must use the same strategy, since TICKET changes how a bucket is unlocked
+enum class LockStrategy {
+    SPIN, // CAS back to back until it succeeds
+    TTAS, // Read the lock until it looks free, and only CAS then. Reads don't queue up on the NIC's atomic unit
+    BACKOFF, // Wait a random, exponentially growing (but bounded) time after each attempt that found the lock held
+    TICKET, // Take a ticket and get the lock in FIFO order. Structures without room for tickets back off instead
+};
+
+/// @brief Which peer holds the plists and elists that inserts and rehashes make. Objects placed in another peer come from the stock it keeps for the others
+enum class Placement {
+    LOCAL, // In the pool of the thread that makes them
+    ROUND_ROBIN, // Each peer in turn
+    HASH_HOME, // The peer whose share of the hash space holds the first key of the object
+    LEAST_LOADED, // The peer that has handed out the fewest bytes of table, so the most of its region is left
+};
+
+/// @brief How many buckets the plist a full elist is split into has. Every peer must use the same policy, since the buckets a key goes to depend on it
+enum class Growth {
+    DOUBLING, // Twice the buckets of its parent. A deep plist is huge even if a single elist overflowed
+    CONSTANT, // PLIST_SIZE buckets at every depth
+    CAPPED, // Twice its parent's, up to CNF_GROWTH_CAP times PLIST_SIZE
+};
+
+/// @brief Counters of the attempts it took to get a lock. Kept by whoever asks for the lock
+struct LockStats {
+    uint64_t acquires = 0; // Locks taken
+    uint64_t retries = 0; // Failed attempts and polls of a held lock, over all acquires
+    uint64_t max_retries = 0; // The most retries of a single acquire
+    uint64_t passes = 0; // Locks passed on by another thread of the node instead of taken remotely
+
+    void record(uint64_t r){
+        acquires++;
+        retries += r;
+        if (r > max_retries) max_retries = r;
+    }
+
+    LockStats& operator+=(const LockStats& other){
+        acquires += other.acquires;
+        retries += other.retries;
+        if (other.max_retries > max_retries) max_retries = other.max_retries;
+        passes += other.passes;
+        return *this;
+    }
+};
+
+/// @brief Runtime options for the IHT. Set from the ExperimentParams so different modes can be compared without recompiling.
+struct IHT_Config {
+    bool optimistic_reads = true; // If contains validates an unlocked read instead of locking the bucket
+    bool replicate_root = true; // If every peer reads from its own copy of the root plist instead of the host's
+    bool local_atomics = false; // If buckets in our own pool are locked and unlocked with CPU atomics instead of looping back through the NIC. Only safe when the NIC's atomics are atomic with the CPU's
+    LockStrategy lock_strategy = LockStrategy::SPIN; // How a thread waits for a locked bucket
+    bool latch_free_inserts = false; // If inserts reserve a slot in the elist instead of locking its bucket. The lock is left to rehash, remove and the inserts that fall back
+    bool offload_splits = false; // If a full elist on another peer is split by that peer, which is asked to over its inbox, instead of over the network by the inserter
+    Placement placement = Placement::LOCAL; // Which peer holds the plists and elists an insert or a rehash makes
+    Growth growth = Growth::DOUBLING; // How many buckets the plist a full elist is split into has. Anything but DOUBLING needs a hash policy that remixes levels
+    size_t max_depth = 0; // The deepest a plist can be. Full elists of a plist at that depth are chained instead of split. 0 for no limit. Every peer must use the same
+    size_t compact_threshold = 0; // A sub-plist that a remove leaves with at most this many pairs (and no sub-plists) is folded back into an elist of its parent's bucket. 0 disables compaction. At most ELIST_SIZE, and only with a reclaimer
+};
+
+/// @brief Counters kept by each IHT instance. Summed across threads and reported with the results.
+struct IHT_Stats {
+    uint64_t plist_cache_hits = 0; // Levels of a descent skipped with the plist cache
+    uint64_t plist_cache_misses = 0; // Sub-plists that had to be found remotely
+    uint64_t ops = 0; // Operations started on the IHT (including populate)
+    uint64_t bytes_read = 0; // Bytes moved by RDMA reads
+    uint64_t bytes_written = 0; // Bytes moved by RDMA writes of buckets and elists
+    uint64_t bulk_loaded = 0; // Pairs inserted by bulk_load
+    uint64_t retired = 0; // Objects handed to the reclaimer: unlinked elists, folded plists and the payloads of removed pairs
+    uint64_t local_atomics = 0; // Bucket locks and unlocks done with CPU atomics instead of the NIC
+    LockStats locks; // Attempts it took to lock buckets
+    uint64_t combined_batches = 0; // Batches of operations this thread applied as the node's combiner
+    uint64_t combined_ops = 0; // Operations in those batches, including the thread's own
+    uint64_t latch_free_inserts = 0; // Inserts committed into a reserved slot, without the bucket's lock
+    uint64_t latch_free_fallbacks = 0; // Inserts that tried a slot but had to take the lock (full, closed or moved elist)
+    uint64_t splits_offloaded = 0; // Full elists of another peer that the peer split for us
+    uint64_t splits_served = 0; // Full elists of ours that we split for another peer
+    uint64_t split_timeouts = 0; // Splits we shipped but did ourselves, because the owner didn't take them in time
+    uint64_t placed_remote = 0; // Plists and elists we made in another peer's pool
+    uint64_t placement_fallbacks = 0; // Ones we made in our own pool instead, because the peer they were for had none in stock
+    uint64_t chained_elists = 0; // ELists added to the chain of a bucket at the max depth
+    uint64_t plists_folded = 0; // Sparse sub-plists folded back into an elist of their parent's bucket
+
+    IHT_Stats& operator+=(const IHT_Stats& other){
+        plist_cache_hits += other.plist_cache_hits;
+        plist_cache_misses += other.plist_cache_misses;
+        ops += other.ops;
+        bytes_read += other.bytes_read;
+        bytes_written += other.bytes_written;
+        bulk_loaded += other.bulk_loaded;
+        retired += other.retired;
+        local_atomics += other.local_atomics;
+        locks += other.locks;
+        combined_batches += other.combined_batches;
+        combined_ops += other.combined_ops;
+        latch_free_inserts += other.latch_free_inserts;
+        latch_free_fallbacks += other.latch_free_fallbacks;
+        splits_offloaded += other.splits_offloaded;
+        splits_served += other.splits_served;
+        split_timeouts += other.split_timeouts;
+        placed_remote += other.placed_remote;
+        placement_fallbacks += other.placement_fallbacks;
+        chained_elists += other.chained_elists;
+        plists_folded += other.plists_folded;
+        return *this;
+    }
+};
+
 typedef uint64_t state_value;
 // Value states
 state_value FALSE_STATE = 1, TRUE_STATE = 2, REHASH_DELETED = 3;
@@ -65,10 +65,27 @@ int main(int argc, char** argv){
     bool do_exp = absl::GetFlag(FLAGS_send_exp);
     assert(!bulk_operations && !test_operations && do_exp); // TODO: remove
     ExperimentParams params = ExperimentParams();
+    IHT_Config config = IHT_Config();
     ResultProto result_proto = ResultProto();
     std::string experiment_parms = absl::GetFlag(FLAGS_experiment_params);
     bool success = google::protobuf::TextFormat::MergeFromString(experiment_parms, &params);
     ROME_ASSERT(success, "Couldn't parse protobuf");
+    config.optimistic_reads = params.optimistic_reads();
+    config.replicate_root = params.replicate_root();
+    // CPU atomics on our own buckets are only atomic with the peers' RDMA atomics if the device says so
+    config.local_atomics = params.local_atomics() && nic_atomics_are_global();
+    if (params.local_atomics() && !config.local_atomics) ROME_INFO("Device atomics are not atomic with the CPU's, local buckets will be locked through the NIC");
+    bool known_strategy = parse_lock_strategy(params.lock_strategy(), config.lock_strategy);
+    ROME_ASSERT(known_strategy, "Unknown lock strategy {}", params.lock_strategy());
+    config.latch_free_inserts = params.latch_free_inserts();
+    config.offload_splits = params.offload_splits();
+    bool known_placement = parse_placement(params.placement(), config.placement);
+    ROME_ASSERT(known_placement, "Unknown placement policy {}", params.placement());
+    bool known_growth = parse_growth(params.growth(), config.growth);
+    ROME_ASSERT(known_growth, "Unknown growth policy {}", params.growth());
+    config.max_depth = params.max_depth();
+    config.compact_threshold = params.compact_threshold();
+    if (config.compact_threshold != 0 && !params.reclaim_memory()) ROME_INFO("Compaction needs memory reclamation, sub-plists won't be folded");
 
     // Check node count
     if (params.node_count() <= 0 || params.thread_count() <= 0){
@@ -166,18 +183,32 @@ int main(int argc, char** argv){
         assert(manager->is_init(endpoint_contexts[i]));
     }
     
+    // The cache of sub-plists is shared by every thread on the node
+    PListCache plist_cache = PListCache(params.plist_cache_size());
+    // So are the cohorts of the bucket locks
+    LockCohort lock_cohort = LockCohort(params.lock_cohort_size());
+    // And the combiner of the operations at a bucket
+    IHT::NodeCombiner combiner = IHT::NodeCombiner(params.combiner_size());
+    // Each memory pool has a reclaimer, shared by the threads that use the pool
+    std::vector<std::unique_ptr<EpochReclaimer>> reclaimers;
+    for (int i = 0; i < mp; i++){
+        MemoryPool::Peer self = peers.at((params.node_id() * mp) + i);
+        reclaimers.push_back(params.reclaim_memory() ? std::make_unique<EpochReclaimer>(self, pools[i]) : nullptr);
+    }
+
     std::barrier client_sync = std::barrier(params.thread_count());
     WorkloadDriverProto results[params.thread_count()];
+    IHT_Stats stats[params.thread_count()];
     for(int i = 0; i < params.thread_count(); i++){
         threads.emplace_back(std::thread([&](int thread_index){
             int mempool_index = thread_index % mp;
             MemoryPool* pool = pools[mempool_index];
             MemoryPool::Peer self = peers.at((params.node_id() * mp) + mempool_index);
             tcp::EndpointContext ctx = endpoint_contexts[thread_index];
-            IHT iht = IHT(self, pool);
+            IHT iht = IHT(self, pool, config, &plist_cache, reclaimers[mempool_index].get(), &lock_cohort, &combiner);
             if (self.id == host.id){
                 // If we are the host
-                remote_ptr<anon_ptr> root_ptr = iht.InitAsFirst();
+                remote_ptr<anon_ptr> root_ptr = iht.InitAsFirst(params.expected_keys(), params.presplit_root());
                 tcp::ExchangePointer(ctx, self, host, root_ptr);
             } else {
                 remote_ptr<anon_ptr> root_ptr = tcp::ExchangePointer(ctx, self, host, remote_nullptr);
@@ -185,13 +216,14 @@ int main(int argc, char** argv){
             }
             ROME_INFO("Creating client");
             // Create and run a client in a thread
-            std::unique_ptr<Client> client = Client::Create(host, ctx, params, &client_sync, &iht, thread_index == 0);
+            std::unique_ptr<Client> client = Client::Create(host, ctx, params, &client_sync, &iht, thread_index == 0, thread_index);
             absl::StatusOr<WorkloadDriverProto> output = Client::Run(std::move(client), &done, 0.5 / (double) (params.node_count() * params.thread_count()));
             if (output.ok()){
                 results[thread_index] = output.value();
             } else {
                 ROME_ERROR("Client run failed");
             }
+            stats[thread_index] = iht.stats;
             ROME_INFO("[CLIENT THREAD] -- End of execution; -- ");
         }, i));
     }
@@ -218,6 +250,62 @@ int main(int argc, char** argv){
     }
     
     ROME_INFO("Total Ops: {}", total_ops);
+
+    IHT_Stats total_stats;
+    for (int i = 0; i < params.thread_count(); i++){
+        total_stats += stats[i];
+    }
+    auto add_stat = [&](std::string name, uint64_t count){
+        MetricProto* m = result_proto.add_stats();
+        m->set_name(name);
+        m->mutable_counter()->set_count(count);
+    };
+    add_stat("plist_cache_hits", total_stats.plist_cache_hits);
+    add_stat("plist_cache_misses", total_stats.plist_cache_misses);
+    ROME_INFO("PList cache: {} hits, {} misses", total_stats.plist_cache_hits, total_stats.plist_cache_misses);
+    add_stat("iht_ops", total_stats.ops);
+    add_stat("bytes_read", total_stats.bytes_read);
+    uint64_t bytes_per_op = total_stats.ops == 0 ? 0 : total_stats.bytes_read / total_stats.ops;
+    add_stat("bytes_read_per_op", bytes_per_op);
+    ROME_INFO("Bytes read: {} over {} ops ({} per op)", total_stats.bytes_read, total_stats.ops, bytes_per_op);
+    add_stat("bytes_written", total_stats.bytes_written);
+    ROME_INFO("Bytes written: {}", total_stats.bytes_written);
+    add_stat("bulk_loaded", total_stats.bulk_loaded);
+    ROME_INFO("Bulk loaded pairs: {}", total_stats.bulk_loaded);
+    add_stat("local_atomics", total_stats.local_atomics);
+    ROME_INFO("Bucket locks and unlocks done with CPU atomics: {}", total_stats.local_atomics);
+    add_stat("lock_acquires", total_stats.locks.acquires);
+    add_stat("lock_retries", total_stats.locks.retries);
+    add_stat("lock_max_retries", total_stats.locks.max_retries);
+    add_stat("lock_passes", total_stats.locks.passes);
+    ROME_INFO("Bucket locks: {} taken with {} retries (at most {}), {} passed within the node", total_stats.locks.acquires, total_stats.locks.retries, total_stats.locks.max_retries, total_stats.locks.passes);
+    add_stat("combined_batches", total_stats.combined_batches);
+    add_stat("combined_ops", total_stats.combined_ops);
+    ROME_INFO("Combiner: {} operations in {} batches", total_stats.combined_ops, total_stats.combined_batches);
+    add_stat("latch_free_inserts", total_stats.latch_free_inserts);
+    add_stat("latch_free_fallbacks", total_stats.latch_free_fallbacks);
+    ROME_INFO("Latch-free inserts: {} committed, {} fell back to the lock", total_stats.latch_free_inserts, total_stats.latch_free_fallbacks);
+    add_stat("splits_offloaded", total_stats.splits_offloaded);
+    add_stat("splits_served", total_stats.splits_served);
+    add_stat("split_timeouts", total_stats.split_timeouts);
+    ROME_INFO("Offloaded splits: {} done by the owner, {} served for others, {} timed out", total_stats.splits_offloaded, total_stats.splits_served, total_stats.split_timeouts);
+    add_stat("placed_remote", total_stats.placed_remote);
+    add_stat("placement_fallbacks", total_stats.placement_fallbacks);
+    ROME_INFO("Placement: {} made in another peer, {} kept local for lack of stock", total_stats.placed_remote, total_stats.placement_fallbacks);
+    add_stat("chained_elists", total_stats.chained_elists);
+    ROME_INFO("ELists chained at the max depth: {}", total_stats.chained_elists);
+    add_stat("plists_folded", total_stats.plists_folded);
+    ROME_INFO("Sparse sub-plists folded: {}", total_stats.plists_folded);
+    uint64_t freed = 0, shipped = 0;
+    for (int i = 0; i < mp; i++){
+        if (reclaimers[i] == nullptr) continue;
+        freed += reclaimers[i]->freed;
+        shipped += reclaimers[i]->shipped;
+    }
+    add_stat("retired", total_stats.retired);
+    add_stat("reclaimed", freed);
+    add_stat("shipped_to_owner", shipped);
+    ROME_INFO("Reclamation: {} retired, {} freed, {} sent back to their owner", total_stats.retired, freed, shipped);
     ROME_INFO("Compiled Proto Results ### {}", result_proto.DebugString());
 
     std::ofstream filestream("iht_result.pbtxt");
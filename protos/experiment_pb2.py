@@ -13,7 +13,7 @@ _sym_db = _symbol_database.Default()
 
 
 
-DESCRIPTOR = _descriptor_pool.Default().AddSerializedFile(b'\n\x10\x65xperiment.proto\"\n\n\x08\x41\x63kProto\"\x8d\x03\n\x10\x45xperimentParams\x12\x15\n\nthink_time\x18\x01 \x02(\x05:\x01\x30\x12\x1b\n\x0fqps_sample_rate\x18\x02 \x02(\x05:\x02\x31\x30\x12\x1a\n\x0emax_qps_second\x18\x03 \x02(\x05:\x02-1\x12\x13\n\x07runtime\x18\x04 \x02(\x05:\x02\x31\x30\x12\x1f\n\x10unlimited_stream\x18\x05 \x02(\x08:\x05\x66\x61lse\x12\x17\n\x08op_count\x18\x06 \x02(\x05:\x05\x31\x30\x30\x30\x30\x12\x14\n\x08\x63ontains\x18\x07 \x02(\x05:\x02\x38\x30\x12\x12\n\x06insert\x18\x08 \x02(\x05:\x02\x31\x30\x12\x12\n\x06remove\x18\t \x02(\x05:\x02\x31\x30\x12\x11\n\x06key_lb\x18\n \x02(\x05:\x01\x30\x12\x17\n\x06key_ub\x18\x0b \x02(\x05:\x07\x31\x30\x30\x30\x30\x30\x30\x12\x17\n\x0bregion_size\x18\x0c \x02(\x05:\x02\x32\x32\x12\x17\n\x0cthread_count\x18\r \x02(\x05:\x01\x31\x12\x15\n\nnode_count\x18\x0e \x02(\x05:\x01\x30\x12\x12\n\x06qp_max\x18\x0f \x02(\x05:\x02\x33\x30\x12\x13\n\x07node_id\x18\x10 \x02(\x05:\x02-1\"Y\n\x0bResultProto\x12!\n\x06params\x18\x01 \x01(\x0b\x32\x11.ExperimentParams\x12\'\n\x06\x64river\x18\x02 \x03(\x0b\x32\x17.IHTWorkloadDriverProto\"\x8c\x01\n\x16IHTWorkloadDriverProto\x12\x19\n\x03ops\x18\x02 \x01(\x0b\x32\x0c.MetricProto\x12\x1d\n\x07runtime\x18\x03 \x01(\x0b\x32\x0c.MetricProto\x12\x19\n\x03qps\x18\x04 \x01(\x0b\x32\x0c.MetricProto\x12\x1d\n\x07latency\x18\x05 \x01(\x0b\x32\x0c.MetricProto\"\x8f\x01\n\x0bMetricProto\x12\x0c\n\x04name\x18\x01 \x01(\t\x12 \n\x07\x63ounter\x18\x02 \x01(\x0b\x32\r.CounterProtoH\x00\x12$\n\tstopwatch\x18\x03 \x01(\x0b\x32\x0f.StopwatchProtoH\x00\x12 \n\x07summary\x18\x04 \x01(\x0b\x32\r.SummaryProtoH\x00\x42\x08\n\x06metric\"\x1d\n\x0c\x43ounterProto\x12\r\n\x05\x63ount\x18\x01 \x01(\x04\"$\n\x0eStopwatchProto\x12\x12\n\nruntime_ns\x18\x01 \x01(\x04\"\xa6\x01\n\x0cSummaryProto\x12\r\n\x05units\x18\x01 \x01(\t\x12\x0c\n\x04mean\x18\x02 \x01(\x01\x12\x0e\n\x06stddev\x18\x03 \x01(\x01\x12\x0b\n\x03min\x18\x04 \x01(\x01\x12\x0b\n\x03p50\x18\x06 \x01(\x01\x12\x0b\n\x03p90\x18\x07 \x01(\x01\x12\x0b\n\x03p95\x18\x08 \x01(\x01\x12\x0b\n\x03p99\x18\t \x01(\x01\x12\x0c\n\x04p999\x18\n \x01(\x01\x12\x0b\n\x03max\x18\x0b \x01(\x01\x12\r\n\x05\x63ount\x18\x0c \x01(\x04')
+DESCRIPTOR = _descriptor_pool.Default().AddSerializedFile(b'\n\x10\x65xperiment.proto\"\n\n\x08\x41\x63kProto\"\x97\x07\n\x10\x45xperimentParams\x12\x15\n\nthink_time\x18\x01 \x02(\x05:\x01\x30\x12\x1b\n\x0fqps_sample_rate\x18\x02 \x02(\x05:\x02\x31\x30\x12\x1a\n\x0emax_qps_second\x18\x03 \x02(\x05:\x02-1\x12\x13\n\x07runtime\x18\x04 \x02(\x05:\x02\x31\x30\x12\x1f\n\x10unlimited_stream\x18\x05 \x02(\x08:\x05\x66\x61lse\x12\x17\n\x08op_count\x18\x06 \x02(\x05:\x05\x31\x30\x30\x30\x30\x12\x14\n\x08\x63ontains\x18\x07 \x02(\x05:\x02\x38\x30\x12\x12\n\x06insert\x18\x08 \x02(\x05:\x02\x31\x30\x12\x12\n\x06remove\x18\t \x02(\x05:\x02\x31\x30\x12\x11\n\x06key_lb\x18\n \x02(\x05:\x01\x30\x12\x17\n\x06key_ub\x18\x0b \x02(\x05:\x07\x31\x30\x30\x30\x30\x30\x30\x12\x17\n\x0bregion_size\x18\x0c \x02(\x05:\x02\x32\x32\x12\x17\n\x0cthread_count\x18\r \x02(\x05:\x01\x31\x12\x15\n\nnode_count\x18\x0e \x02(\x05:\x01\x30\x12\x12\n\x06qp_max\x18\x0f \x02(\x05:\x02\x33\x30\x12\x13\n\x07node_id\x18\x10 \x02(\x05:\x02-1\x12\x1e\n\x10optimistic_reads\x18\x11 \x01(\x08:\x04true\x12\x1f\n\x10plist_cache_size\x18\x12 \x01(\x05:\x05\x33\x32\x37\x36\x38\x12\x1c\n\x0ereplicate_root\x18\x13 \x01(\x08:\x04true\x12\x1c\n\x0ereclaim_memory\x18\x15 \x01(\x08:\x04true\x12\x18\n\tbulk_load\x18\x16 \x01(\x08:\x05\x66\x61lse\x12\x18\n\x0e\x62ulk_load_file\x18\x17 \x01(\t:\x00\x12\x1b\n\rlocal_atomics\x18\x18 \x01(\x08:\x04true\x12\x1b\n\rlock_strategy\x18\x19 \x01(\t:\x04spin\x12\x1e\n\x10lock_cohort_size\x18\x1a \x01(\x05:\x04\x34\x30\x39\x36\x12\x1b\n\rcombiner_size\x18\x1b \x01(\x05:\x04\x34\x30\x39\x36\x12!\n\x12latch_free_inserts\x18\x1c \x01(\x08:\x05\x66\x61lse\x12\x1d\n\x0eoffload_splits\x18\x1d \x01(\x08:\x05\x66\x61lse\x12\x18\n\tplacement\x18\x1e \x01(\t:\x05local\x12\x18\n\x06growth\x18\x1f \x01(\t:\x08\x64oubling\x12\x14\n\tmax_depth\x18  \x01(\x05:\x01\x30\x12\x18\n\rexpected_keys\x18! \x01(\x03:\x01\x30\x12\x1c\n\rpresplit_root\x18\" \x01(\x08:\x05\x66\x61lse\x12\x1c\n\x11\x63ompact_threshold\x18# \x01(\x05:\x01\x30\"v\n\x0bResultProto\x12!\n\x06params\x18\x01 \x01(\x0b\x32\x11.ExperimentParams\x12\'\n\x06\x64river\x18\x02 \x03(\x0b\x32\x17.IHTWorkloadDriverProto\x12\x1b\n\x05stats\x18\x03 \x03(\x0b\x32\x0c.MetricProto\"\x8c\x01\n\x16IHTWorkloadDriverProto\x12\x19\n\x03ops\x18\x02 \x01(\x0b\x32\x0c.MetricProto\x12\x1d\n\x07runtime\x18\x03 \x01(\x0b\x32\x0c.MetricProto\x12\x19\n\x03qps\x18\x04 \x01(\x0b\x32\x0c.MetricProto\x12\x1d\n\x07latency\x18\x05 \x01(\x0b\x32\x0c.MetricProto\"\x8f\x01\n\x0bMetricProto\x12\x0c\n\x04name\x18\x01 \x01(\t\x12 \n\x07\x63ounter\x18\x02 \x01(\x0b\x32\r.CounterProtoH\x00\x12$\n\tstopwatch\x18\x03 \x01(\x0b\x32\x0f.StopwatchProtoH\x00\x12 \n\x07summary\x18\x04 \x01(\x0b\x32\r.SummaryProtoH\x00\x42\x08\n\x06metric\"\x1d\n\x0c\x43ounterProto\x12\r\n\x05\x63ount\x18\x01 \x01(\x04\"$\n\x0eStopwatchProto\x12\x12\n\nruntime_ns\x18\x01 \x01(\x04\"\xa6\x01\n\x0cSummaryProto\x12\r\n\x05units\x18\x01 \x01(\t\x12\x0c\n\x04mean\x18\x02 \x01(\x01\x12\x0e\n\x06stddev\x18\x03 \x01(\x01\x12\x0b\n\x03min\x18\x04 \x01(\x01\x12\x0b\n\x03p50\x18\x06 \x01(\x01\x12\x0b\n\x03p90\x18\x07 \x01(\x01\x12\x0b\n\x03p95\x18\x08 \x01(\x01\x12\x0b\n\x03p99\x18\t \x01(\x01\x12\x0c\n\x04p999\x18\n \x01(\x01\x12\x0b\n\x03max\x18\x0b \x01(\x01\x12\r\n\x05\x63ount\x18\x0c \x01(\x04')
 
 _globals = globals()
 _builder.BuildMessageAndEnumDescriptors(DESCRIPTOR, _globals)
@@ -23,17 +23,17 @@ if _descriptor._USE_C_DESCRIPTORS == False:
   _globals['_ACKPROTO']._serialized_start=20
   _globals['_ACKPROTO']._serialized_end=30
   _globals['_EXPERIMENTPARAMS']._serialized_start=33
-  _globals['_EXPERIMENTPARAMS']._serialized_end=430
-  _globals['_RESULTPROTO']._serialized_start=432
-  _globals['_RESULTPROTO']._serialized_end=521
-  _globals['_IHTWORKLOADDRIVERPROTO']._serialized_start=524
-  _globals['_IHTWORKLOADDRIVERPROTO']._serialized_end=664
-  _globals['_METRICPROTO']._serialized_start=667
-  _globals['_METRICPROTO']._serialized_end=810
-  _globals['_COUNTERPROTO']._serialized_start=812
-  _globals['_COUNTERPROTO']._serialized_end=841
-  _globals['_STOPWATCHPROTO']._serialized_start=843
-  _globals['_STOPWATCHPROTO']._serialized_end=879
-  _globals['_SUMMARYPROTO']._serialized_start=882
-  _globals['_SUMMARYPROTO']._serialized_end=1048
+  _globals['_EXPERIMENTPARAMS']._serialized_end=952
+  _globals['_RESULTPROTO']._serialized_start=954
+  _globals['_RESULTPROTO']._serialized_end=1072
+  _globals['_IHTWORKLOADDRIVERPROTO']._serialized_start=1075
+  _globals['_IHTWORKLOADDRIVERPROTO']._serialized_end=1215
+  _globals['_METRICPROTO']._serialized_start=1218
+  _globals['_METRICPROTO']._serialized_end=1361
+  _globals['_COUNTERPROTO']._serialized_start=1363
+  _globals['_COUNTERPROTO']._serialized_end=1392
+  _globals['_STOPWATCHPROTO']._serialized_start=1394
+  _globals['_STOPWATCHPROTO']._serialized_end=1430
+  _globals['_SUMMARYPROTO']._serialized_start=1433
+  _globals['_SUMMARYPROTO']._serialized_end=1599
 # @@protoc_insertion_point(module_scope)
@@ -25,6 +25,7 @@ using ::rome::WorkloadDriver;
 using ::rome::WorkloadDriverProto;
 
 typedef RdmaIHT<int, int, CNF_ELIST_SIZE, CNF_PLIST_SIZE> IHT;
+// typedef RdmaIHT<int, int, CNF_ELIST_SIZE, CNF_PLIST_SIZE, MixedLevelHash<int>> IHT;
 // typedef Hashtable<int, int, CNF_PLIST_SIZE> IHT;
 // typedef TestMap<int, int> IHT;
 
@@ -54,8 +55,8 @@ typedef IHT_Op<int, int> Operation;
 class Client : public ClientAdaptor<Operation> {
 public:
   static std::unique_ptr<Client>
-  Create(const MemoryPool::Peer &server, const tcp::EndpointContext &ctx, ExperimentParams& params, std::barrier<> *barrier, IHT* iht, bool master_client) {
-    return std::unique_ptr<Client>(new Client(server, ctx, params, barrier, iht, master_client));
+  Create(const MemoryPool::Peer &server, const tcp::EndpointContext &ctx, ExperimentParams& params, std::barrier<> *barrier, IHT* iht, bool master_client, int thread_index) {
+    return std::unique_ptr<Client>(new Client(server, ctx, params, barrier, iht, master_client, thread_index));
   }
 
   /// @brief Run the client
@@ -66,9 +67,13 @@ public:
   static absl::StatusOr<WorkloadDriverProto> Run(std::unique_ptr<Client> client, volatile bool *done, double frac) {
     int key_lb = client->params_.key_lb(), key_ub = client->params_.key_ub();
     int op_count = (key_ub - key_lb) * frac;
-    ROME_INFO("CLIENT :: Data structure ({}%) is being populated ({} items inserted) by this client", frac * 100, op_count);
     client->iht_->pool_->RegisterThread();
-    client->iht_->populate(op_count, key_lb, key_ub, [=](int key){ return key; });
+    if (client->params_.bulk_load()){
+      client->BulkLoad(frac);
+    } else {
+      ROME_INFO("CLIENT :: Data structure ({}%) is being populated ({} items inserted) by this client", frac * 100, op_count);
+      client->iht_->populate(op_count, key_lb, key_ub, [=](int key){ return key; });
+    }
     ROME_INFO("CLIENT :: Done with populate!");
 
     // TODO: Sleeping for 1 second to account for difference between remote client start times. Must fix this in the future to a better solution
@@ -163,7 +168,6 @@ public:
         if (count % progression == 0) ROME_INFO("Running Operation {}: contains({})", count, op.key);
         // ROME_INFO("Running Operation {}: contains({})", count, op.key);
         res = iht_->contains(op.key);
-        if (res.status == TRUE_STATE) ROME_ASSERT(res.result == op.key, "Invalid result of ({}) contains operation {}!={}", res.status, res.result, op.key);
         break;
       case(INSERT):
         if (count % progression == 0) ROME_INFO("Running Operation {}: insert({}, {})", count, op.key, op.value);
@@ -174,20 +178,41 @@ public:
         if (count % progression == 0) ROME_INFO("Running Operation {}: remove({})", count, op.key);
         // ROME_INFO("Running Operation {}: remove({})", count, op.key);
         res = iht_->remove(op.key);
-        if (res.status == TRUE_STATE) ROME_ASSERT(res.result == op.key, "Invalid result of ({}) remove operation {}!={}", res.status, res.result, op.key);
         break;
       default:
         ROME_INFO("Expected CONTAINS, INSERT, or REMOVE operation.");
         break;
     }
-    // Think in between operations for simulation purposes. 
-    if (params_.has_think_time() && params_.think_time() != 0){
-      auto start = util::SystemClock::now();
-      while (util::SystemClock::now() - start < std::chrono::nanoseconds(params_.think_time()));
-    }
+    check_result(op, res);
+    think();
     return absl::OkStatus();
   }
 
+  /// @brief Populate the data structure with a bulk load. Every client loads its share of the root buckets
+  /// @param frac the fraction of the key range each client would insert with populate
+  void BulkLoad(double frac){
+    size_t parts = params_.node_count() * params_.thread_count();
+    size_t part = params_.node_id() * params_.thread_count() + thread_index_;
+    if (!params_.bulk_load_file().empty()){
+      iht_->bulk_load_file(params_.bulk_load_file(), part, parts);
+    } else {
+      // Every client draws the same keys as a whole populate would (with the same seed), and keeps the ones of its part
+      int key_lb = params_.key_lb(), key_range = params_.key_ub() - params_.key_lb();
+      int total = key_range * frac * parts;
+      std::uniform_real_distribution<double> dist = std::uniform_real_distribution<double>(0.0, 1.0);
+      std::default_random_engine gen((unsigned) key_lb);
+      std::vector<int> keys;
+      for (int c = 0; c < total; c++){
+        int k = dist(gen) * key_range + key_lb;
+        if (iht_->load_part_of(k, parts) == part) keys.push_back(k);
+      }
+      // We populate with value == key
+      iht_->bulk_load(keys, keys, part, parts);
+    }
+    // The count is reported with the other stats
+    ROME_INFO("CLIENT :: Bulk loaded part {} of {}", part, parts);
+  }
+
   /// @brief Runs single-client silent-server test cases on the iht
   /// @param at_scale is true for testing at scale (+10,000 operations)
   /// @return OkStatus if everything worked. Otherwise will shutdown the client.
@@ -257,12 +282,26 @@ public:
   }
 
 private:
-  Client(const MemoryPool::Peer &host, const tcp::EndpointContext ctx, ExperimentParams &params, std::barrier<> *barrier, IHT* iht, bool master_client)
-      : host_(host), endpoint_ctx_(ctx), params_(params), barrier_(barrier), iht_(iht), master_client_(master_client) {
+  Client(const MemoryPool::Peer &host, const tcp::EndpointContext ctx, ExperimentParams &params, std::barrier<> *barrier, IHT* iht, bool master_client, int thread_index)
+      : host_(host), endpoint_ctx_(ctx), params_(params), barrier_(barrier), iht_(iht), master_client_(master_client), thread_index_(thread_index) {
         if (params.unlimited_stream()) progression = 10000;
         else progression = params_.op_count() * 0.001;
       }
 
+  /// @brief Validate the result of an operation (we populate with value == key)
+  void check_result(const Operation &op, const HT_Res<int> &res){
+    if (op.op_type == CONTAINS && res.status == TRUE_STATE) ROME_ASSERT(res.result == op.key, "Invalid result of ({}) contains operation {}!={}", res.status, res.result, op.key);
+    if (op.op_type == REMOVE && res.status == TRUE_STATE) ROME_ASSERT(res.result == op.key, "Invalid result of ({}) remove operation {}!={}", res.status, res.result, op.key);
+  }
+
+  // Think in between operations for simulation purposes. 
+  void think(){
+    if (params_.has_think_time() && params_.think_time() != 0){
+      auto start = util::SystemClock::now();
+      while (util::SystemClock::now() - start < std::chrono::nanoseconds(params_.think_time()));
+    }
+  }
+
   int count = 0;
 
   const MemoryPool::Peer host_;
@@ -271,6 +310,7 @@ private:
   std::barrier<> *barrier_;
   IHT* iht_;
   bool master_client_;
+  int thread_index_; // Index of the client's thread on its node
 
   int progression;
 };
\ No newline at end of file
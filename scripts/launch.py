@@ -42,6 +42,24 @@ flags.DEFINE_integer('op_count', required=False, default=10000, help="The number
 flags.DEFINE_list('key_range', required=False, default=['0', '1e6'], help="Pass in two values to be the [lb,ub] of the key range. Can use e-notation as well.")
 flags.DEFINE_integer('region_size', required=False, default=22, help="2 ^ x bytes to allocate on each node")
 flags.DEFINE_bool('default', required=False, default=False, help="If to run the experiment with the default proto command")
+flags.DEFINE_bool('optimistic_reads', required=False, default=True, help="If contains should read without locking the bucket (False uses the locked path)")
+flags.DEFINE_bool('replicate_root', required=False, default=True, help="If each peer keeps a local replica of the root plist")
+flags.DEFINE_integer('plist_cache_size', required=False, default=32768, help="Entries in each node's cache of sub-plist pointers. 0 disables the cache")
+flags.DEFINE_bool('reclaim_memory', required=False, default=True, help="If ELists unlinked by rehash and remove are freed (False leaks them)")
+flags.DEFINE_bool('bulk_load', required=False, default=False, help="If the data structure is populated with a bulk load instead of one insert at a time")
+flags.DEFINE_bool('local_atomics', required=False, default=True, help="If buckets in a node's own memory are locked with CPU atomics, when the NIC supports it")
+flags.DEFINE_enum('lock_strategy', ['spin', 'ttas', 'backoff', 'ticket'], required=False, default='spin', help="How a thread waits for a locked bucket")
+flags.DEFINE_integer('lock_cohort_size', required=False, default=4096, help="Node-local cohorts the bucket locks are striped over. 0 disables cohorting")
+flags.DEFINE_integer('combiner_size', required=False, default=4096, help="Stripes of the node-local combiner of same-bucket operations. 0 disables combining")
+flags.DEFINE_bool('latch_free_inserts', required=False, default=False, help="If inserts reserve a slot in the elist with a fetch-and-add instead of locking the bucket")
+flags.DEFINE_bool('offload_splits', required=False, default=False, help="If a full elist is split by the node that holds it instead of by the inserter")
+flags.DEFINE_enum('placement', ['local', 'round_robin', 'hash_home', 'least_loaded'], required=False, default='local', help="Which node holds the plists and elists that inserts make")
+flags.DEFINE_enum('growth', ['doubling', 'constant', 'capped'], required=False, default='doubling', help="How many buckets the plist a full elist is split into has. constant and capped need the MixedLevelHash typedef in role_client.h")
+flags.DEFINE_integer('max_depth', required=False, default=0, help="The deepest a plist can be before full elists are chained instead of split. 0 for no limit")
+flags.DEFINE_integer('compact_threshold', required=False, default=0, help="Fold a sub-plist back into an elist once a remove leaves it with at most this many pairs. 0 disables compaction")
+flags.DEFINE_integer('expected_keys', required=False, default=0, help="How many keys the table is expected to hold, to size the root for. 0 for the smallest root")
+flags.DEFINE_bool('presplit_root', required=False, default=False, help="If every root bucket starts with an empty sub-plist, so the root is sized for two levels")
+flags.DEFINE_string('bulk_load_file', required=False, default="", help="A file of binary (key, value) records to bulk load. Empty generates the same keys as populate")
 
 # Cluster parameters
 flags.DEFINE_integer('thread_count', required=False, default=1, help="The number of threads to start per client. Only applicable in send_exp")
@@ -104,8 +122,13 @@ def process_exp_flags(node_id):
             one_to_ones = ["think_time", "qps_sample_rate", "max_qps_second", "runtime", "unlimited_stream", "op_count", "contains", "insert", "remove", "key_lb", "key_ub", "region_size", "thread_count", "node_count", "qp_max"]
             for param in one_to_ones:
                 exec(f"params.{param} = mapper['{param}']")
+            # Optional parameters keep their proto default when missing from the config
+            optionals = ["optimistic_reads", "plist_cache_size", "replicate_root", "reclaim_memory", "bulk_load", "bulk_load_file", "local_atomics", "lock_strategy", "lock_cohort_size", "combiner_size", "latch_free_inserts", "offload_splits", "placement", "growth", "max_depth", "expected_keys", "presplit_root", "compact_threshold"]
+            for param in optionals:
+                if param in mapper:
+                    exec(f"params.{param} = mapper['{param}']")
     elif not FLAGS.default:
-        one_to_ones = ["think_time", "qps_sample_rate", "max_qps_second", "runtime", "unlimited_stream", "op_count", "region_size", "thread_count", "node_count", "qp_max"]
+        one_to_ones = ["think_time", "qps_sample_rate", "max_qps_second", "runtime", "unlimited_stream", "op_count", "region_size", "thread_count", "node_count", "qp_max", "optimistic_reads", "plist_cache_size", "replicate_root", "reclaim_memory", "bulk_load", "bulk_load_file", "local_atomics", "lock_strategy", "lock_cohort_size", "combiner_size", "latch_free_inserts", "offload_splits", "placement", "growth", "max_depth", "expected_keys", "presplit_root", "compact_threshold"]
         for param in one_to_ones:
             exec(f"params.{param} = FLAGS.{param}")
         contains, insert, remove = FLAGS.op_distribution.split("-")
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "common.h"
+
+/// @brief Flat combining of the operations a node's threads make at the same bucket, shared by all the threads of a node.
+/// A thread publishes its operation in the stripe of its bucket. If no one is combining for the stripe, it becomes the combiner:
+/// it takes every published operation at its bucket, applies them under a single lock of the bucket, and hands each one its result.
+/// The others wait for their result. Buckets are mapped to stripes by address, and the buckets of a stripe take turns at combining
+template <typename K, typename V>
+class Combiner {
+public:
+    enum state_t {
+        PENDING, // Waiting for a combiner
+        DONE, // Applied, result is set
+        RETRY, // Not applied. The operation has to go on by itself (the bucket is a sub-plist now, or its elist is full)
+    };
+
+    /// @brief A published operation. Lives with the thread that published it
+    struct request_t {
+        uint64_t slot; // The packed pointer to the bucket (the one that is locked)
+        int op_type; // CONTAINS, INSERT or REMOVE
+        K key;
+        uint64_t hash; // The hash of key
+        V value; // The value to insert. Only used by INSERT
+        HT_Res<V> result = HT_Res<V>(FALSE_STATE, V());
+        state_t state = PENDING;
+    };
+
+private:
+    struct alignas(64) stripe_t {
+        std::mutex lock;
+        std::condition_variable finished; // Signaled when a combiner is done
+        std::vector<request_t*> pending; // Published operations, in the order they came in
+        bool combining = false;
+    };
+
+    size_t mask_;
+    std::unique_ptr<stripe_t[]> stripes_;
+
+    // splitmix64 finalizer, to spread the bucket addresses (which are 8 byte aligned) across the stripes
+    inline stripe_t& stripe_of(uint64_t slot){
+        uint64_t h = slot;
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+        return stripes_[(h ^ (h >> 31)) & mask_];
+    }
+
+public:
+    /// @brief Create the combiner
+    /// @param stripes the number of stripes. Rounded down to a power of two. 0 disables combining
+    Combiner(size_t stripes){
+        size_t count = 1;
+        while (count * 2 <= stripes) count *= 2;
+        mask_ = count - 1;
+        if (stripes != 0) stripes_ = std::make_unique<stripe_t[]>(count);
+    }
+
+    bool enabled() const {
+        return stripes_ != nullptr;
+    }
+
+    /// @brief Publish an operation, and wait until a combiner applied it or it is our turn to combine
+    /// @param req the operation
+    /// @param batch set to the operations to combine if it is our turn, req and every other one at its bucket, in the order they came in
+    /// @return if we have to combine batch and then call finish. Otherwise req is DONE or RETRY
+    bool publish(request_t &req, std::vector<request_t*> &batch){
+        stripe_t& s = stripe_of(req.slot);
+        std::unique_lock<std::mutex> guard(s.lock);
+        s.pending.push_back(&req);
+        while (true){
+            if (req.state != PENDING) return false;
+            if (!s.combining){
+                s.combining = true;
+                batch.clear();
+                auto keep = s.pending.begin();
+                for (request_t* r : s.pending){
+                    if (r->slot == req.slot) batch.push_back(r);
+                    else *keep++ = r;
+                }
+                s.pending.erase(keep, s.pending.end());
+                return true;
+            }
+            s.finished.wait(guard);
+        }
+    }
+
+    /// @brief Hand the operations of a batch back to their threads. Their states are set under the stripe's lock, which the waiting threads
+    /// read them under, so the results written before are visible to them too
+    /// @param slot the bucket of the batch
+    /// @param batch the operations of the batch, as publish gave them
+    /// @param done how many of them (from the front) were applied. The rest are RETRY
+    void finish(uint64_t slot, const std::vector<request_t*> &batch, size_t done){
+        stripe_t& s = stripe_of(slot);
+        {
+            std::lock_guard<std::mutex> guard(s.lock);
+            for (size_t i = 0; i < batch.size(); i++) batch[i]->state = i < done ? DONE : RETRY;
+            s.combining = false;
+        }
+        s.finished.notify_all();
+    }
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+// A hash policy decides which bucket a key goes to at each level of plists.
+// hash() is called once per operation, and bucket() turns that hash into the bucket of every level the operation descends through.
+// Every peer must use the same policy, since the buckets it picks (and the hashes kept in payload pairs) are shared.
+// REMIXES_LEVELS tells if keys that share a bucket at one level are spread again at the next when both levels have the same count.
+// Constant and capped growth give deep plists the count of their parent, so they need a policy that does.
+
+/// @brief The original scheme, and RdmaIHT's default: std::hash xor the level, mod count - 1.
+/// std::hash is the identity for integers, so clustered keys stay clustered at every level, and each level pays a division.
+/// A dense range of keys fills the buckets evenly though, so it needs far fewer plists than under MixedLevelHash
+template <typename K>
+struct ModuloLevelHash {
+    // The level only flips the low bits of the hash, so keys that share a bucket mostly share it again under the same count
+    static constexpr bool REMIXES_LEVELS = false;
+
+    uint64_t hash(const K& key) const {
+        return std::hash<K>()(key);
+    }
+
+    uint64_t bucket(uint64_t hash, size_t level, size_t count) const {
+        return (level ^ hash) % (count-1); // we use count-1 because this prevents the collision errors associated with "mod 2A" given "mod A"
+    }
+};
+
+/// @brief Mixes the key with a wyhash style multiply, and gives each level its own remix of the hash.
+/// Keys that share a bucket at one level (the ones that end up in the same sub-plist) are spread independently at the next.
+/// The bucket is picked from the top bits with a multiply and shift instead of a division
+template <typename K>
+struct MixedLevelHash {
+    static constexpr bool REMIXES_LEVELS = true;
+
+    /// @brief Fold the 128 bit product of a and b into 64 bits
+    static inline uint64_t mum(uint64_t a, uint64_t b){
+        unsigned __int128 r = (unsigned __int128) a * b;
+        return (uint64_t) r ^ (uint64_t) (r >> 64);
+    }
+
+    uint64_t hash(const K& key) const {
+        return mum(std::hash<K>()(key) ^ 0xa0761d6478bd642full, 0xe7037ed1a0b428dbull);
+    }
+
+    uint64_t bucket(uint64_t hash, size_t level, size_t count) const {
+        // The root uses the hash itself. A 64 bit hash doesn't have enough bits for a separate slice at every level, so deeper levels remix it
+        uint64_t slice = level == 1 ? hash : mum(hash ^ (level * 0x8ebc6af09c88c6e3ull), 0x589965cc75374cc3ull);
+        return (uint64_t) (((unsigned __int128) slice * count) >> 64);
+    }
+};
@@ -307,8 +307,6 @@ public:
         for (int c = 0; c < op_count; c++){
             int k = dist(gen) * key_range + key_lb;
             insert(k, value(k));
-            // Wait some time before doing next insert...
-            std::this_thread::sleep_for(std::chrono::nanoseconds(10));
         }
     }
 };
@@ -1,8 +1,24 @@
 #pragma once
 
 #include <infiniband/verbs.h>
+#include <algorithm>
+#include <bit>
+#include <chrono>
 #include <cstdint>
+#include <cstring>
 #include <atomic>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 #include "rome/rdma/channel/sync_accessor.h"
 #include "rome/rdma/connection_manager/connection.h"
@@ -11,6 +27,13 @@
 #include "rome/rdma/rdma_memory.h"
 #include "rome/logging/logging.h"
 #include "common.h"
+#include "combiner.h"
+#include "hash_policy.h"
+#include "lock_cohort.h"
+#include "payload.h"
+#include "placement.h"
+#include "plist_cache.h"
+#include "reclaim.h"
 
 using ::rome::rdma::ConnectionManager;
 using ::rome::rdma::MemoryPool;
@@ -18,42 +41,221 @@ using ::rome::rdma::remote_nullptr;
 using ::rome::rdma::remote_ptr;
 using ::rome::rdma::RemoteObjectProto;
 
-template<class K, class V, int ELIST_SIZE, int PLIST_SIZE>
+/// @brief If the atomics of every RDMA device are atomic with the CPU's (IBV_ATOMIC_GLOB).
+/// Most devices only guarantee that RDMA atomics are atomic with each other (IBV_ATOMIC_HCA). A CPU CAS racing with an RDMA CAS on such a device
+/// can have both succeed, so local memory that remote peers CAS must go through the NIC too.
+inline bool nic_atomics_are_global(){
+    int n = 0;
+    ibv_device** devices = ibv_get_device_list(&n);
+    if (devices == nullptr) return false;
+    bool global = n > 0;
+    for (int i = 0; i < n; i++){
+        ibv_context* ctx = ibv_open_device(devices[i]);
+        ibv_device_attr attr;
+        if (ctx == nullptr || ibv_query_device(ctx, &attr) != 0 || attr.atomic_cap != IBV_ATOMIC_GLOB) global = false;
+        if (ctx != nullptr) ibv_close_device(ctx);
+    }
+    ibv_free_device_list(devices);
+    return global;
+}
+
+/// @brief Parse the name of a growth policy, as given to the experiment
+/// @param name one of doubling, constant or capped
+/// @param out set to the policy if the name is known
+/// @return if the name is known
+inline bool parse_growth(const std::string& name, Growth& out){
+    if (name == "doubling") out = Growth::DOUBLING;
+    else if (name == "constant") out = Growth::CONSTANT;
+    else if (name == "capped") out = Growth::CAPPED;
+    else return false;
+    return true;
+}
+
+template<class K, class V, int ELIST_SIZE, int PLIST_SIZE, class Hash = ModuloLevelHash<K>, int BUCKET_PAIRS = CNF_BUCKET_PAIRS>
 class RdmaIHT {
 private:
     MemoryPool::Peer self_;
+    IHT_Config config_;
+    PListCache* cache_; // Node-wide cache of sub-plists. Can be nullptr
+    EpochReclaimer* reclaimer_; // The reclaimer of our peer. Can be nullptr, which leaks what is unlinked
+    int reclaim_slot_ = -1; // Our thread's slot in the reclaimer
+    LockCohort* cohort_; // Node-wide cohorts of the bucket locks. Can be nullptr
+    uint64_t cohort_slot_ = 0; // The bucket we hold through its cohort (0 if none). The synchronous operations hold one bucket at a time
+    uint64_t cohort_bucket_ = 0; // That bucket as we locked it
+    Combiner<K, V>* combiner_; // Node-wide combiner of the operations at a bucket. Can be nullptr
 
     // "Poor-mans" enum to represent the state of a node. P-lists cannot be locked 
     // E_LOCKED = 1, E_UNLOCKED = 2, P_UNLOCKED = 3
     const uint64_t E_LOCKED = 1, E_UNLOCKED = 2, P_UNLOCKED = 3;
+    // The buckets of a sub-plist that compaction folded back into an elist of its parent's bucket. Can't be locked either. An operation that
+    // reaches one (with a stale read of the parent, or a stale cache entry) starts over from the root
+    const uint64_t FOLDED = 0;
+
+    static const uint64_t FNV_BASIS = 14695981039346656037ull;
+
+    /// @brief Mix bytes into an FNV-1a hash. The checksums that let lock-free readers detect a torn read are built with it
+    static inline void fnv_mix(uint64_t &h, const void* data, size_t len){
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < len; i++){
+            h ^= bytes[i];
+            h *= 1099511628211ull;
+        }
+    }
 
     // "Super class" for the elist and plist structs
     struct Base {};
-    typedef uint64_t lock_type;
     typedef remote_ptr<Base> remote_baseptr;
-    typedef remote_ptr<lock_type> remote_lock;
+
+    // A bucket is a single word: the pointer to its EList or PList, with the state of the bucket in the low bits.
+    // ELists and PLists are aligned to 64 bytes so those bits of the address are always 0. A single CAS can lock a bucket and return where it points.
+    typedef uint64_t bucket_t;
+    typedef remote_ptr<bucket_t> remote_bucket;
+    const uint64_t STATE_MASK = 0x3;
+    // Under the ticket lock strategy the next 4 bits are a ticket lock: 2 bits for the ticket being served and 2 for the next one to hand out.
+    // Tickets wrap at 4, so at most 3 threads hold or wait for a bucket at once. The bucket is E_LOCKED whenever a ticket is out
+    const uint64_t TICKET_MASK = 0x3C;
+    const uint64_t TICKETS = 4;
 
     // ElementList stores a bunch of K/V pairs. IHT employs a "seperate chaining"-like approach.
     // Rather than storing via a linked list (with easy append), it uses a fixed size array
     struct alignas(64) EList : Base {
-        struct pair_t {
+        // A pair stored in the EList itself
+        struct inline_pair_t {
             K key;
             V val;
         };
 
-        size_t count = 0; // The number of live elements in the Elist
+        // A pair whose key and value are in a payload of their own, the encoded key followed by the encoded value.
+        // The hash of the key is kept as a fingerprint, so a search only fetches the payload of a pair whose fingerprint matches and a rehash never does
+        struct payload_pair_t {
+            uint64_t fingerprint; // The hash of the key
+            uint64_t payload; // Packed pointer to the payload
+            uint32_t key_len;
+            uint32_t val_len;
+        };
+
+        // Small trivially copyable pairs stay inline, so searching them doesn't take another read
+        static constexpr bool INLINE = stored_inline<K, V>;
+        typedef std::conditional_t<INLINE, inline_pair_t, payload_pair_t> pair_t;
+
+        // Count value of an EList that was rehashed into a PList. Tells a lock-free reader holding a stale pointer to start over
+        static const uint16_t MOVED = 0xFFFF;
+        // Flag in reserved of an EList that latch-free inserts can't reserve slots in or commit to anymore
+        static const uint16_t CLOSED = 0x8000;
+
+        // Room for the tags, in whole 16 byte vectors so a search can load them without reading past the end
+        static constexpr size_t TAG_COUNT = (ELIST_SIZE + 15) / 16 * 16;
+        static_assert(ELIST_SIZE <= 64, "The tags of an EList are matched into a 64 bit mask");
+
+        // checksum, count and reserved share the first word (see meta), so a latch-free insert can CAS them together
+        uint32_t checksum = 0; // Digest of count, tags and pairs. A single RDMA read isn't atomic, so lock-free readers use it to detect a torn read
+        uint16_t count = 0; // The number of live elements in the Elist
+        uint16_t reserved = 0; // The slots handed out: count plus the latch-free inserts that haven't committed yet. The top bit is CLOSED
+        uint64_t overflow = 0; // Packed pointer to the next elist of the bucket's chain. Only a bucket of a plist at the max depth chains, and its elists stay CLOSED
+        uint8_t tags[TAG_COUNT] = {}; // One byte of the hash of each pair's key, stored together so a search compares them all at once
         pair_t pairs[ELIST_SIZE]; // A list of pairs to store (stored as remote pointer to start of the contigous memory block)
-        
-        // Insert into elist a deconstructed pair
-        void elist_insert(const K key, const V val){
-            pairs[count] = {key, val};
-            count++;
+
+        /// FNV-1a over the count, the overflow pointer, the live tags and the live pairs, folded to 32 bits
+        uint32_t digest() const {
+            uint64_t h = FNV_BASIS;
+            fnv_mix(h, &count, sizeof(count));
+            fnv_mix(h, &overflow, sizeof(overflow));
+            if (count <= ELIST_SIZE){
+                fnv_mix(h, tags, count);
+                fnv_mix(h, pairs, sizeof(pair_t) * count);
+            }
+            return h ^ (h >> 32);
+        }
+
+        /// Recompute the checksum. Must be called after every modification
+        void seal(){
+            checksum = digest();
+        }
+
+        /// If the EList was read in a state that some writer actually produced
+        bool is_consistent() const {
+            return (count <= ELIST_SIZE || count == MOVED) && checksum == digest();
+        }
+
+        bool is_moved() const {
+            return count == MOVED;
+        }
+
+        /// The first word of the EList: the checksum in the low 32 bits, then count, then reserved
+        uint64_t meta() const {
+            static_assert(std::endian::native == std::endian::little, "The fields of the first word of an EList are laid out little endian");
+            uint64_t m;
+            std::memcpy(&m, &checksum, sizeof(m));
+            return m;
+        }
+
+        static uint16_t count_of(uint64_t m){
+            return m >> 32;
+        }
+
+        /// The slots handed out in a first word, without the CLOSED flag
+        static uint16_t reserved_of(uint64_t m){
+            return (m >> 48) & ~CLOSED;
+        }
+
+        static bool is_closed(uint64_t m){
+            return (m >> 48) & CLOSED;
+        }
+
+        /// A first word with its reserved field (flag included) replaced
+        static uint64_t with_reserved(uint64_t m, uint64_t reserved){
+            return (m & 0xFFFFFFFFFFFFull) | (reserved << 48);
+        }
+
+        /// A mask of the live slots whose tag is t. Candidates only, the keys of the slots still have to be compared
+        uint64_t match_tags(uint8_t t) const {
+            uint64_t mask = 0;
+            size_t i = 0;
+#if defined(__AVX2__)
+            __m256i wide = _mm256_set1_epi8((char) t);
+            for (; i + 32 <= TAG_COUNT; i += 32){
+                __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tags + i));
+                mask |= (uint64_t) (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, wide)) << i;
+            }
+#endif
+#if defined(__SSE2__)
+            __m128i narrow = _mm_set1_epi8((char) t);
+            for (; i + 16 <= TAG_COUNT; i += 16){
+                __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tags + i));
+                mask |= (uint64_t) (uint16_t) _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, narrow)) << i;
+            }
+#endif
+            for (; i < TAG_COUNT; i++){
+                if (tags[i] == t) mask |= 1ull << i;
+            }
+            return count >= 64 ? mask : mask & ((1ull << count) - 1);
         }
 
-        // Insert into elist a pair
-        void elist_insert(const pair_t pair){
+        // Insert into elist a pair with the tag of its key
+        void elist_insert(const pair_t pair, uint8_t tag){
+            tags[count] = tag;
             pairs[count] = pair;
             count++;
+            reserved = (reserved & CLOSED) | count;
+            seal();
+        }
+
+        // Remove the pair at index i by swapping in the last pair
+        void elist_remove(size_t i){
+            if (count > 1){
+                // Edge swap if not count=0|1
+                tags[i] = tags[count - 1];
+                pairs[i] = pairs[count - 1];
+            }
+            count--;
+            reserved = (reserved & CLOSED) | count;
+            seal();
+        }
+
+        // Mark the elist as rehashed into a plist
+        void mark_moved(){
+            count = MOVED;
+            seal();
         }
 
         EList(){
@@ -61,57 +263,326 @@ private:
         }
     };
 
-    // A pointer lock pair
-    struct plist_pair_t {
-        remote_baseptr base; // Pointer to base, the super class of Elist or Plist
-        remote_lock lock; // A lock to represent if the base is open or not
-        // TODO: Maybe I can manipulate the lock without needing a pointer?
+    typedef typename EList::pair_t pair_t;
+
+    // The pairs a bucket holds itself, right after its word. A bucket with a null pointer keeps its pairs here until they outgrow it,
+    // and then they spill to an EList. Most buckets hold a couple of pairs at most, so a search usually ends with the read that found the bucket
+    static_assert(BUCKET_PAIRS < ELIST_SIZE, "The pairs of a bucket have to fit in the EList they spill to");
+    struct InlinePairs {
+        uint32_t checksum = 0; // Digest of the bucket's pointer, count, tags and pairs. With the pointer, a reader can tell if the pairs go with the word it read
+        uint16_t count = 0;
+        uint8_t tags[BUCKET_PAIRS > 0 ? BUCKET_PAIRS : 1] = {};
+        pair_t pairs[BUCKET_PAIRS > 0 ? BUCKET_PAIRS : 1];
+    };
+
+    // A bucket and its pairs, as they are laid out in a plist
+    struct Slot {
+        bucket_t word;
+        InlinePairs inline_pairs;
     };
+    // The room a bucket takes in a plist. Just its word without inline pairs
+    static constexpr size_t SLOT_WORDS = BUCKET_PAIRS > 0 ? sizeof(Slot) / sizeof(bucket_t) : 1;
+    static_assert(sizeof(Slot) % sizeof(bucket_t) == 0, "Buckets must stay aligned to a word");
 
-    // PointerList stores EList pointers and assorted locks
+    // PointerList stores the buckets, which point to ELists or PLists
     struct alignas(64) PList : Base {
-        plist_pair_t buckets[PLIST_SIZE]; // Pointer lock pairs
+        bucket_t buckets[PLIST_SIZE * SLOT_WORDS]; // Tagged pointers, each followed by the bucket's inline pairs if it has room for some
     };
 
     typedef remote_ptr<PList> remote_plist;
     typedef remote_ptr<EList> remote_elist;
 
+    // The most peers that can hold a replica of the root. Peers with a larger id read the host's root
+    static const int MAX_REPLICAS = 64;
+    // Tag on a directory entry whose replica is still being filled in
+    static const uint64_t REPLICA_FILLING = 1;
+
+    // Table metadata allocated by the host. Its pointer is the one exchanged at startup
+    struct alignas(64) Header {
+        remote_plist root; // The root plist. Always the one that is written first
+        uint64_t root_count; // The number of buckets in root, PLIST_SIZE times a power of two. Every peer hashes keys into root with it
+        uint64_t replicas[MAX_REPLICAS]; // Packed pointers to each peer's copy of the root (0 if the peer has none)
+        uint64_t replicas_version; // Bumped by each registration of a replica, so writers of root know when to read replicas again
+        EpochReclaimer::remote_table reclaim; // Epoch table shared by the reclaimers of every peer
+        uint64_t split_inboxes[MAX_REPLICAS]; // Packed pointers to each peer's inbox of splits to do for others (0 if the peer takes none)
+        uint64_t stocks[MAX_REPLICAS]; // Packed pointers to each peer's stock of objects for others to place there (0 if the peer keeps none)
+    };
+    typedef remote_ptr<Header> remote_header;
+
+    // A split shipped to the owner of a full elist. Lives in the inserter's pool, and is linked into the owner's inbox through next
+    struct split_req_t {
+        uint64_t next; // Packed pointer to the next request of the inbox
+        uint64_t state; // One of the SPLIT_ states below, or the packed pointer to the sub-plist once the owner is done
+        uint64_t curr; // Packed pointer to the plist of the bucket. root itself for a root bucket, never a replica
+        uint64_t bucket;
+        uint64_t elist; // Packed pointer to the full elist, which the owner holds
+        uint64_t count; // The number of buckets in curr
+        uint64_t depth; // The depth of curr
+    };
+    typedef remote_ptr<split_req_t> remote_split;
+    static const uint64_t SPLIT_PENDING = 1, SPLIT_TAKEN = 2, SPLIT_CANCELLED = 3, SPLIT_DROPPED = 4;
+
     /// @brief Initialize the plist with values.
     /// @param p the plist pointer to init
     /// @param depth the depth of p, needed for PLIST_SIZE == base_size * (2 ** (depth - 1))
     /// pow(2, depth)
     inline void InitPList(remote_plist p, int mult_modder){
         for (size_t i = 0; i < PLIST_SIZE * mult_modder; i++){
-            p->buckets[i].lock = pool_->Allocate<lock_type>();
-            *p->buckets[i].lock = E_UNLOCKED;
-            p->buckets[i].base = remote_nullptr;
+            local_bucket(p, i) = make_bucket(remote_nullptr, E_UNLOCKED);
+            if constexpr (BUCKET_PAIRS > 0){
+                local_pairs(p, i) = InlinePairs();
+                seal_pairs(0, local_pairs(p, i));
+            }
         }
     }
 
+    /// @brief A bucket of a plist in our own memory
+    inline bucket_t& local_bucket(remote_plist p, uint64_t bucket){
+        return p->buckets[bucket * SLOT_WORDS];
+    }
+
+    /// @brief The inline pairs of a bucket of a plist in our own memory
+    inline InlinePairs& local_pairs(remote_plist p, uint64_t bucket){
+        return reinterpret_cast<Slot*>(&p->buckets[bucket * SLOT_WORDS])->inline_pairs;
+    }
+
+    remote_header header; // Table metadata
     remote_plist root;  // Start of plist
-    std::hash<K> pre_hash; // Hash function from k -> size_t [this currently does nothing as the value of the int can just be returned :: though included for templating this class]
+    remote_plist local_root; // The root plist we read from. Our replica of root, or root itself if not replicating
+    size_t root_count = PLIST_SIZE; // The number of buckets in root (and so in every replica of it), as the header has it
+    remote_ptr<uint64_t> split_inbox_ = remote_nullptr; // Our peer's inbox of splits to do for others. Null if we take none
+    std::vector<remote_plist> replicas_; // The replicas of root other than root, as root_replicas() last read them
+    uint64_t replicas_version_ = UINT64_MAX; // The header's replicas_version when replicas_ was read. Never a real version at first
+    uint64_t split_inboxes_[MAX_REPLICAS] = {}; // The inboxes of the other peers, as we last read them from the header
+    std::vector<remote_split> cancelled_splits_; // Requests we gave up on, which the owner still has to drop before they can be freed
+    remote_ptr<PlacementStock> stock_ = remote_nullptr; // Our peer's stock of objects for others to place here. Null if we keep none
+    uint64_t stocks_[MAX_REPLICAS] = {}; // The stocks of every peer, as we last read them from the header
+    uint64_t loads_[MAX_REPLICAS] = {}; // The bytes each peer had handed out when we last read it, plus what we placed there since
+    std::vector<uint16_t> placement_peers_; // The peers with a stock, which objects can be placed in
+    uint64_t placements_ = 0; // Objects we placed. Every CNF_PLACEMENT_REFRESH, the stocks are read again
+    size_t next_peer_ = 0; // The next peer of ROUND_ROBIN
+    Hash hasher_; // Picks the bucket of a key at each level. Each operation hashes its key once
     
-    /// Acquire a lock on the bucket. Will prevent others from modifying it
-    bool acquire(remote_lock lock){
-        // Spin while trying to acquire the lock
-        while (true){
-            lock_type v = pool_->CompareAndSwap<lock_type>(lock, E_UNLOCKED, E_LOCKED);
+    /// @brief Make a bucket out of a pointer and a state
+    inline bucket_t make_bucket(remote_baseptr base, uint64_t state){
+        bucket_t b = pack_ptr(base);
+        ROME_ASSERT((b & (STATE_MASK | TICKET_MASK)) == 0, "Bucket pointer must be aligned to 64 bytes");
+        return b | state;
+    }
+
+    inline uint64_t state_of(bucket_t b){
+        return b & STATE_MASK;
+    }
+
+    inline remote_baseptr base_of(bucket_t b){
+        return unpack_ptr<Base>(b & ~(STATE_MASK | TICKET_MASK));
+    }
+
+    inline bucket_t with_state(bucket_t b, uint64_t state){
+        return (b & ~STATE_MASK) | state;
+    }
 
+    /// @brief If a bucket is past locking: it points to a sub-plist, or its plist was folded
+    inline bool is_permanent(bucket_t b){
+        return state_of(b) == P_UNLOCKED || state_of(b) == FOLDED;
+    }
+
+    /// @brief The ticket a ticket locked bucket is serving
+    inline uint64_t serving_of(bucket_t b){
+        return (b >> 2) & (TICKETS - 1);
+    }
+
+    /// @brief The next ticket a ticket locked bucket hands out
+    inline uint64_t next_ticket_of(bucket_t b){
+        return (b >> 4) & (TICKETS - 1);
+    }
+
+    inline bucket_t with_tickets(bucket_t b, uint64_t serving, uint64_t next){
+        return (b & ~TICKET_MASK) | ((serving & (TICKETS - 1)) << 2) | ((next & (TICKETS - 1)) << 4);
+    }
+
+    /// @brief The bucket a free bucket would be locked to, by taking its next ticket. Without the ticket strategy, unlocking writes the ticket back
+    inline bucket_t take_ticket(bucket_t b){
+        return with_tickets(with_state(b, E_LOCKED), serving_of(b), next_ticket_of(b) + 1);
+    }
+
+    /// @brief The remote address of a bucket in a plist
+    inline remote_bucket bucket_slot(remote_plist p, uint64_t bucket){
+        return remote_bucket(p.id(), p.address() + sizeof(bucket_t) * SLOT_WORDS * bucket);
+    }
+
+    /// @brief The bucket to lock and write for a bucket of a plist. Root buckets are only locked in the root itself, never in a replica
+    inline remote_bucket lock_slot(remote_plist curr, uint64_t bucket){
+        if (config_.replicate_root && curr == local_root) return bucket_slot(root, bucket);
+        return bucket_slot(curr, bucket);
+    }
+
+    /// @brief Acquire a lock on the bucket. Will prevent others from modifying it
+    /// With a cohort, only one thread of the node goes for the bucket, and it might be passed the bucket by another without the bucket being unlocked
+    /// @param slot the bucket to lock
+    /// @param b the bucket as we last saw it. Updated to the bucket we locked, or the permanently unlocked bucket (whose pointer is the sub-plist)
+    /// @return true if we locked an elist bucket, false if the bucket points to a plist or its plist was folded
+    bool acquire(remote_bucket slot, bucket_t &b){
+        if (cohort_ == nullptr || !cohort_->enabled()) return acquire_remote(slot, b);
+        uint64_t addr = pack_ptr(slot);
+        LockCohort::held_t held = cohort_->enter(addr);
+        if (held.addr == addr){
+            stats.locks.passes++;
+            b = held.value;
+        } else {
+            // The cohort kept another bucket (of the same stripe) locked for us
+            if (held.addr != 0) unlock_remote(unpack_ptr<bucket_t>(held.addr), held.value);
+            if (!acquire_remote(slot, b)){
+                cohort_->leave(addr);
+                return false;
+            }
+        }
+        cohort_slot_ = addr;
+        cohort_bucket_ = b;
+        return true;
+    }
+
+    /// @brief Lock the bucket itself
+    /// The CAS that takes the lock returns the current bucket, so a stale copy is fixed by retrying with what the CAS returned
+    bool acquire_remote(remote_bucket slot, bucket_t &b){
+        if (config_.lock_strategy == LockStrategy::TICKET) return acquire_ticket(slot, b);
+        LockWaiter waiter(config_.lock_strategy, &stats.locks);
+        while (true){
             // Permanent unlock
-            if (v == P_UNLOCKED) return false;
-            // If we can switch from unlock to lock status
-            if (v == E_UNLOCKED) return true;
+            if (is_permanent(b)) return false;
+            if (waiter.test_first() && state_of(b) == E_LOCKED){
+                // Wait for the holder with plain reads
+                b = read_word(slot);
+                waiter.retry(true);
+                continue;
+            }
+            if (try_lock(slot, b)){
+                waiter.acquired();
+                return true;
+            }
+            waiter.retry(state_of(b) == E_LOCKED);
+        }
+    }
+
+    /// @brief acquire for the ticket strategy. Takes the bucket's next ticket with a CAS, then reads the bucket until that ticket is served
+    bool acquire_ticket(remote_bucket slot, bucket_t &b){
+        LockWaiter waiter(LockStrategy::TICKET, &stats.locks);
+        while (true){
+            if (is_permanent(b)) return false;
+            if (((next_ticket_of(b) - serving_of(b)) & (TICKETS - 1)) == TICKETS - 1){
+                // Every ticket is out, wait for one to be served
+                b = read_word(slot);
+                waiter.retry(true);
+                continue;
+            }
+            bucket_t v = cas_word(slot, b, take_ticket(b));
+            if (v != b){
+                b = v;
+                waiter.retry(false);
+                continue;
+            }
+            uint64_t ticket = next_ticket_of(b);
+            while (serving_of(b) != ticket){
+                b = read_word(slot);
+                // The holder rehashed the bucket (or folded its plist). Every waiter follows it to the sub-plist, giving its ticket back on the way
+                if (is_permanent(b)){
+                    return_ticket(slot, b);
+                    return false;
+                }
+                waiter.retry(true);
+            }
+            waiter.acquired();
+            b = with_tickets(with_state(b, E_UNLOCKED), ticket, ticket);
+            return true;
         }
     }
 
+    /// @brief Give back a ticket of a bucket that was made permanently unlocked while we waited. Such a bucket has the waiters that still have to leave
+    /// as its tickets out. A fold waits for them, or one that missed the bucket being permanent could be served its ticket by a lock of the folded bucket
+    void return_ticket(remote_bucket slot, bucket_t b){
+        while (true){
+            bucket_t v = cas_word(slot, b, with_tickets(b, serving_of(b) + 1, next_ticket_of(b)));
+            if (v == b) return;
+            b = v;
+        }
+    }
+
+    /// @brief A single attempt at locking an elist bucket
+    /// @param slot the bucket to lock
+    /// @param b the bucket as we last saw it, which must not be permanently unlocked. Updated to what the CAS returned
+    /// @return if we locked the bucket
+    inline bool try_lock(remote_bucket slot, bucket_t &b){
+        // A free bucket has no tickets out
+        bucket_t expected = with_tickets(with_state(b, E_UNLOCKED), serving_of(b), serving_of(b));
+        bucket_t v = cas_word(slot, expected, take_ticket(expected));
+        // If we can switch from unlock to lock status
+        if (v == expected){
+            b = expected;
+            return true;
+        }
+        b = v;
+        return false;
+    }
+
     /// @brief Unlock a lock ==> the reverse of acquire
-    /// @param lock the lock to unlock
-    /// @param unlock_status what should the end lock status be.
-    inline void unlock(remote_lock lock, uint64_t unlock_status){
-        remote_lock temp = pool_->Allocate<lock_type>();
-        pool_->Write<lock_type>(lock, unlock_status, temp); 
+    /// @param slot the bucket to unlock
+    /// @param b what the bucket should be after unlocking (pointer and unlocked status)
+    inline void unlock(remote_bucket slot, bucket_t b){
+        uint64_t addr = pack_ptr(slot);
+        if (cohort_slot_ == 0 || cohort_slot_ != addr){
+            unlock_remote(slot, b);
+            return;
+        }
+        cohort_slot_ = 0;
+        // Only a bucket we didn't change can be passed on. The others must be written, for the readers that don't lock
+        if (b == cohort_bucket_ && cohort_->pass(addr, b)) return;
+        unlock_remote(slot, b);
+        cohort_->leave(addr);
+    }
+
+    /// @brief Unlock the bucket itself
+    inline void unlock_remote(remote_bucket slot, bucket_t b){
+        if (config_.lock_strategy != LockStrategy::TICKET){
+            write_word(slot, b);
+            return;
+        }
+        // Serve the next ticket. Others take tickets while we hold the bucket, so this is a CAS on what is there, starting from a guess that no one did
+        bucket_t held = take_ticket(with_tickets(b, serving_of(b), serving_of(b)));
+        while (true){
+            uint64_t serving = serving_of(held) + 1, next = next_ticket_of(held);
+            // The bucket stays locked if it goes to a waiter, unless it is now a sub-plist or folded (which the waiters follow)
+            uint64_t state = (serving & (TICKETS - 1)) == next || is_permanent(b) ? state_of(b) : E_LOCKED;
+            bucket_t v = cas_word(slot, held, with_tickets(with_state(b, state), serving, next));
+            if (v == held) return;
+            held = v;
+        }
+    }
+
+    /// @brief CAS a word that peers CAS too: a bucket, or the first word of an elist
+    /// @return the word before the CAS, which is expected if it succeeded
+    inline uint64_t cas_word(remote_ptr<uint64_t> word, uint64_t expected, uint64_t desired){
+        if (use_local_atomics(word)){
+            // The failed CAS leaves the word it saw in expected, like the NIC's CAS returns it
+            stats.local_atomics++;
+            std::atomic_ref<uint64_t>(*std::to_address(word)).compare_exchange_strong(expected, desired, std::memory_order_acq_rel);
+            return expected;
+        }
+        return pool_->CompareAndSwap<uint64_t>(word, expected, desired);
+    }
+
+    /// @brief Write a word that peers CAS with a single write
+    inline void write_word(remote_ptr<uint64_t> word, uint64_t value){
+        if (use_local_atomics(word)){
+            // Release, so what we wrote under the lock is visible to the next local holder
+            stats.local_atomics++;
+            std::atomic_ref<uint64_t>(*std::to_address(word)).store(value, std::memory_order_release);
+            return;
+        }
+        remote_ptr<uint64_t> temp = pool_->Allocate<uint64_t>();
+        stats.bytes_written += sizeof(uint64_t);
+        pool_->Write<uint64_t>(word, value, temp); 
         // Have to deallocate "8" of them to account for alignment
-        pool_->Deallocate<lock_type>(temp, 8);
+        pool_->Deallocate<uint64_t>(temp, 8);
     }
 
     template <typename T>
@@ -124,323 +595,2007 @@ private:
         return ptr == remote_nullptr;
     }
 
-    /// @brief Change the baseptr from a given bucket (could be remote as well) 
-    /// @param before_localized_curr the start of the bucket list (plist)
+    /// @brief If a bucket (or another word peers CAS) is locked and unlocked with CPU atomics. Only words in our own pool, and only if the device makes that safe (see nic_atomics_are_global)
+    inline bool use_local_atomics(remote_ptr<uint64_t> word){
+        return config_.local_atomics && is_local(word);
+    }
+
+    /// @brief Point a locked bucket somewhere else and unlock it, with a single write. Changes to the root go to every replica of it
+    /// @param curr the start of the bucket list (plist)
     /// @param bucket the bucket to write to
     /// @param baseptr the new pointer that bucket should point to
-    inline void change_bucket_pointer(remote_plist before_localized_curr, uint64_t bucket, remote_baseptr baseptr){
-        uint64_t address_of_baseptr = before_localized_curr.address();
-        address_of_baseptr += sizeof(plist_pair_t) * bucket;
-        remote_ptr<remote_baseptr> magic_baseptr = remote_ptr<remote_baseptr>(before_localized_curr.id(), address_of_baseptr);
-        if (!is_local(magic_baseptr)){ 
-            // Have to use a temp variable to account for alignment. Remote pointer is 8 bytes!
-            auto temp = pool_->Allocate<remote_baseptr>();
-            pool_->Write<remote_baseptr>(magic_baseptr, baseptr, temp); 
-            pool_->Deallocate<remote_baseptr>(temp, 8);
-        }
-        else *magic_baseptr = baseptr;
+    /// @param unlock_status what should the end lock status be.
+    inline void change_bucket_pointer(remote_plist curr, uint64_t bucket, remote_baseptr baseptr, uint64_t unlock_status){
+        bucket_t b = make_bucket(baseptr, unlock_status);
+        if (config_.replicate_root && curr == local_root) publish_root_bucket(bucket, b);
+        unlock(lock_slot(curr, bucket), b);
     }
 
-    // Hashing function to decide bucket size
-    inline uint64_t level_hash(const K &key, size_t level, size_t count){
-        return (level ^ pre_hash(key)) % (count-1); // we use count-1 because this prevents the collision errors associated with "mod 2A" given "mod A"
+    /// @brief Write a root bucket to every replica of root. Must hold the bucket's lock
+    /// The replicas are written before root is unlocked, so a thread that locks the bucket next sees the new pointer in its replica
+    void publish_root_bucket(uint64_t bucket, bucket_t b){
+        for (remote_plist replica : root_replicas()) write_word(bucket_slot(replica, bucket), b);
     }
 
-    /// Rehash function
-    /// @param parent The P-List whose bucket needs rehashing
-    /// @param pcount The number of elements in `parent`
-    /// @param pdepth The depth of `parent`
-    /// @param pidx   The index in `parent` of the bucket to rehash
-    remote_plist rehash(remote_plist parent, size_t pcount, size_t pdepth, size_t pidx){
-        pcount = pcount * 2;
-        int plist_size_factor = (pcount / PLIST_SIZE); // pow(2, pdepth); // how much bigger than original size we are 
-        
-        // 2 ^ (depth) ==> in other words (depth:factor). 0:1, 1:2, 2:4, 3:8, 4:16, 5:32. 
-        remote_plist new_p = pool_->Allocate<PList>(plist_size_factor);
-        InitPList(new_p, plist_size_factor);
-
-        // hash everything from the full elist into it
-        remote_elist parent_bucket = static_cast<remote_elist>(parent->buckets[pidx].base);
-        remote_elist source = is_local(parent_bucket) ? parent_bucket : pool_->Read<EList>(parent_bucket);
-        for (size_t i = 0; i < source->count; i++){
-            uint64_t b = level_hash(source->pairs[i].key, pdepth + 1, pcount);
-            if (is_null(new_p->buckets[b].base)){
-                remote_elist e = pool_->Allocate<EList>();
-                new_p->buckets[b].base = static_cast<remote_baseptr>(e);
-            }
-            remote_elist dest = static_cast<remote_elist>(new_p->buckets[b].base);
-            dest->elist_insert(source->pairs[i]);
+    /// @brief The replicas of root that writers of a root bucket keep up to date, besides root itself.
+    /// Only the header's version word is read each time. The list is read again when a registration bumped it. A replica registered
+    /// after that read refreshes the bucket under its lock, so it sees what we write before unlocking
+    const std::vector<remote_plist>& root_replicas(){
+        remote_ptr<uint64_t> version = remote_ptr<uint64_t>(header.id(), header.address() + offsetof(Header, replicas_version));
+        uint64_t v = read_word(version);
+        if (v == replicas_version_) return replicas_;
+        replicas_.clear();
+        if (!is_local(header)) stats.bytes_read += sizeof(Header);
+        remote_header h = is_local(header) ? header : pool_->Read<Header>(header);
+        for (int i = 0; i < MAX_REPLICAS; i++){
+            if (h->replicas[i] == 0) continue;
+            remote_plist replica = unpack_ptr<PList>(h->replicas[i] & ~REPLICA_FILLING);
+            if (replica != root) replicas_.push_back(replica);
         }
-        // Deallocate the old elist
-        pool_->Deallocate<EList>(source);
-        return new_p;
+        if (!is_local(header)) pool_->Deallocate<Header>(h);
+        replicas_version_ = v;
+        return replicas_;
     }
-public:
-    MemoryPool* pool_;
 
-    using conn_type = MemoryPool::conn_type;
+    /// @brief Read a single bucket of a plist
+    inline bucket_t read_bucket(remote_plist p, uint64_t bucket){
+        return read_word(bucket_slot(p, bucket));
+    }
 
-    RdmaIHT(MemoryPool::Peer self, MemoryPool* pool) : self_(self), pool_(pool){
-        if ((PLIST_SIZE * 8) % 64 != 0) ROME_INFO("Warning: Suboptimal PLIST_SIZE b/c PList needs to be aligned to 64 bytes");
-        if (((ELIST_SIZE * 8) + 4) % 64 < 60) ROME_INFO("Warning: Suboptimal ELIST_SIZE b/c EList needs to be aligned to 64 bytes");
-    };
+    /// @brief Read a word that peers CAS (a bucket, or the first word of an elist) by its address
+    inline uint64_t read_word(remote_ptr<uint64_t> word){
+        if (is_local(word)) return std::atomic_ref<uint64_t>(*std::to_address(word)).load(std::memory_order_acquire);
+        remote_ptr<uint64_t> red = pool_->Read<uint64_t>(word);
+        stats.bytes_read += sizeof(uint64_t);
+        uint64_t w = *std::to_address(red);
+        // Have to deallocate "8" of them to account for alignment
+        pool_->Deallocate<uint64_t>(red, 8);
+        return w;
+    }
 
-    /// @brief Create a fresh iht
-    /// @return the iht root pointer
-    remote_ptr<anon_ptr> InitAsFirst(){
-        remote_plist iht_root = pool_->Allocate<PList>();
-        InitPList(iht_root, 1);
-        this->root = iht_root;
-        return static_cast<remote_ptr<anon_ptr>>(iht_root);
+    /// @brief The digest of the inline pairs of a bucket, for the pointer of the bucket they go with
+    uint32_t pairs_digest(uint64_t base, const InlinePairs &pairs){
+        uint64_t h = FNV_BASIS;
+        fnv_mix(h, &base, sizeof(base));
+        fnv_mix(h, &pairs.count, sizeof(pairs.count));
+        fnv_mix(h, pairs.tags, pairs.count);
+        fnv_mix(h, pairs.pairs, sizeof(pair_t) * pairs.count);
+        return h ^ (h >> 32);
     }
 
-    /// @brief Initialize an IHT from the pointer of another IHT
-    /// @param root_ptr the root pointer of the other iht from InitAsFirst();
-    void InitFromPointer(remote_ptr<anon_ptr> root_ptr){
-        this->root = static_cast<remote_plist>(root_ptr);
+    /// @brief Recompute the checksum of inline pairs, which go with a bucket pointing to base
+    inline void seal_pairs(uint64_t base, InlinePairs &pairs){
+        pairs.checksum = pairs_digest(base, pairs);
     }
 
-    /// @brief Gets a value at the key.
-    /// @param key the key to search on
-    /// @return if the key was found or not. The value at the key is stored in RdmaIHT::result
-    HT_Res<V> contains(K key){
-        // start at root
-        remote_plist curr = pool_->Read<PList>(root);
-        remote_plist before_localized_curr = root;
-        size_t depth = 1, count = PLIST_SIZE;
-        bool oldBucketBase = true;
-        while (true) {
-            uint64_t bucket = level_hash(key, depth, count);
-            if (!acquire(curr->buckets[bucket].lock)){
-                // Can't lock then we are at a sub-plist
-                // Therefore we must re-fetch the PList to ensure freshness of our pointers (1 << depth-1 to adjust size of read with customized ExtendedRead)
-                remote_plist curr_temp = pool_->ExtendedRead<PList>(before_localized_curr, 1 << (depth - 1));
-                remote_plist bucket_base = static_cast<remote_plist>(curr_temp->buckets[bucket].base);
-                remote_plist base_ptr = is_local(bucket_base) || is_null(bucket_base) ? bucket_base : pool_->ExtendedRead<PList>(bucket_base, 1 << depth);
-                pool_->Deallocate<PList>(curr_temp, 1 << (depth - 1));
+    /// @brief Read a single bucket of a plist along with its inline pairs, in one read. Re-read until the pairs go with the bucket
+    /// @param pairs set to the pairs of the bucket. None if the bucket has an elist or is a sub-plist
+    inline bucket_t read_bucket(remote_plist p, uint64_t bucket, InlinePairs &pairs){
+        pairs.count = 0;
+        if constexpr (BUCKET_PAIRS == 0) return read_bucket(p, bucket);
+        remote_bucket slot = bucket_slot(p, bucket);
+        while (true){
+            bucket_t b;
+            if (is_local(slot)){
+                b = std::atomic_ref<bucket_t>(local_bucket(p, bucket)).load(std::memory_order_acquire);
+                pairs = local_pairs(p, bucket);
+            } else {
+                remote_ptr<Slot> red = pool_->Read<Slot>(remote_ptr<Slot>(slot.id(), slot.address()));
+                stats.bytes_read += sizeof(Slot);
+                b = red->word;
+                pairs = red->inline_pairs;
+                pool_->Deallocate<Slot>(red);
+            }
+            // Only a bucket without an elist uses its pairs
+            if (is_permanent(b) || !is_null(base_of(b))){
+                pairs.count = 0;
+                return b;
+            }
+            if (pairs.count <= BUCKET_PAIRS && pairs.checksum == pairs_digest(pack_ptr(base_of(b)), pairs)) return b;
+        }
+    }
 
-                if (oldBucketBase) pool_->Deallocate<PList>(curr, 1 << (depth - 1)); // deallocate if curr was not ours
-                oldBucketBase = !is_local(bucket_base); // setting the old bucket base
+    /// @brief Read the inline pairs of a locked bucket
+    InlinePairs read_pairs(remote_bucket slot){
+        InlinePairs pairs;
+        if constexpr (BUCKET_PAIRS > 0){
+            remote_ptr<InlinePairs> at = remote_ptr<InlinePairs>(slot.id(), slot.address() + offsetof(Slot, inline_pairs));
+            if (is_local(slot)){
+                pairs = *std::to_address(at);
+            } else {
+                remote_ptr<InlinePairs> red = pool_->Read<InlinePairs>(at);
+                stats.bytes_read += sizeof(InlinePairs);
+                pairs = *std::to_address(red);
+                pool_->Deallocate<InlinePairs>(red);
+            }
+        }
+        return pairs;
+    }
 
-                before_localized_curr = bucket_base;
-                curr = base_ptr;
-                depth++;
-                count *= 2;
+    /// @brief Write the inline pairs of a locked bucket, sealed for the pointer the bucket will have. Changes to the root go to every replica of it.
+    /// Written before the bucket, so a reader that sees the new pointer with the old pairs re-reads
+    void write_pairs(remote_plist curr, uint64_t bucket, remote_baseptr base, InlinePairs pairs){
+        seal_pairs(pack_ptr(base), pairs);
+        std::vector<remote_bucket> slots = {lock_slot(curr, bucket)};
+        if (config_.replicate_root && curr == local_root){
+            for (remote_plist replica : root_replicas()) slots.push_back(bucket_slot(replica, bucket));
+        }
+        for (remote_bucket slot : slots){
+            remote_ptr<InlinePairs> at = remote_ptr<InlinePairs>(slot.id(), slot.address() + offsetof(Slot, inline_pairs));
+            if (is_local(slot)){
+                *std::to_address(at) = pairs;
                 continue;
             }
+            stats.bytes_written += sizeof(InlinePairs);
+            pool_->Write<InlinePairs>(at, pairs);
+        }
+    }
 
-            // We locked an elist, we can read the baseptr and progress
-            remote_elist bucket_base = static_cast<remote_elist>(curr->buckets[bucket].base);
-            remote_elist e = is_local(bucket_base) || is_null(bucket_base) ? bucket_base : pool_->Read<EList>(bucket_base);
+    /// @brief Make a replica of root in our pool and register it in the header, so writers of root keep it up to date.
+    /// Threads sharing our pool share the replica.
+    void register_replica(){
+        if (self_.id >= MAX_REPLICAS){
+            ROME_INFO("Warning: Peer {} is past MAX_REPLICAS and will read the host's root", self_.id);
+            local_root = root;
+            return;
+        }
+        remote_ptr<uint64_t> entry = remote_ptr<uint64_t>(header.id(), header.address() + offsetof(Header, replicas) + sizeof(uint64_t) * self_.id);
 
-            // Past this point we have recursed to an elist
-            if (is_null(e)){
-                // empty elist
-                unlock(curr->buckets[bucket].lock, E_UNLOCKED);
-                if (oldBucketBase) pool_->Deallocate<PList>(curr, 1 << (depth - 1)); // deallocate if curr was not ours
-                return HT_Res<V>(FALSE_STATE, 0);
+        // Start from an unlocked copy of root, which might be stale
+        int factor = root_count / PLIST_SIZE;
+        remote_plist replica = pool_->Allocate<PList>(factor);
+        remote_plist root_copy = pool_->ExtendedRead<PList>(root, factor);
+        std::copy_n(std::to_address(root_copy), factor, std::to_address(replica));
+        pool_->Deallocate<PList>(root_copy, factor);
+
+        uint64_t prev = pool_->CompareAndSwap<uint64_t>(entry, 0, pack_ptr(replica) | REPLICA_FILLING);
+        if (prev != 0){
+            // Another thread on our pool registered first. Wait for it to finish filling the replica in
+            pool_->Deallocate<PList>(replica, factor);
+            while (prev & REPLICA_FILLING){
+                remote_ptr<uint64_t> red = pool_->Read<uint64_t>(entry);
+                prev = *std::to_address(red);
+                pool_->Deallocate<uint64_t>(red, 8);
             }
+            local_root = unpack_ptr<PList>(prev);
+            return;
+        }
+        // Writers of root that cached the replicas read them again
+        remote_ptr<uint64_t> version = remote_ptr<uint64_t>(header.id(), header.address() + offsetof(Header, replicas_version));
+        uint64_t v = read_word(version);
+        for (uint64_t seen; (seen = cas_word(version, v, v + 1)) != v; v = seen);
 
-            // Get elist and linear search
-            for (size_t i = 0; i < e->count; i++){
-                // Linear search to determine if elist already contains the key
-                if (e->pairs[i].key == key){
-                    K result = e->pairs[i].val;
-                    unlock(curr->buckets[bucket].lock, E_UNLOCKED);
-                    if (!is_local(bucket_base)) pool_->Deallocate<EList>(e);
-                    if (oldBucketBase) pool_->Deallocate<PList>(curr, 1 << (depth - 1)); // deallocate if curr was not ours
-                    return HT_Res<V>(TRUE_STATE, result);
-                }
+        // Now that writers of root see the replica, refresh each bucket under its lock. A permanently unlocked bucket is only changed
+        // by compaction, which writes the replica itself, so it is refreshed only if no one wrote it since the copy
+        for (uint64_t i = 0; i < root_count; i++){
+            remote_bucket slot = bucket_slot(root, i);
+            bucket_t copied = local_bucket(replica, i);
+            bucket_t b = copied;
+            if (acquire(slot, b)){
+                if constexpr (BUCKET_PAIRS > 0) local_pairs(replica, i) = read_pairs(slot);
+                local_bucket(replica, i) = b;
+                unlock(slot, b);
+                continue;
             }
+            std::atomic_ref<bucket_t>(local_bucket(replica, i)).compare_exchange_strong(copied, b);
+        }
+        uint64_t filling = pack_ptr(replica) | REPLICA_FILLING;
+        pool_->CompareAndSwap<uint64_t>(entry, filling, pack_ptr(replica));
+        local_root = replica;
+    }
 
-            // Can't find, unlock and return false
-            unlock(curr->buckets[bucket].lock, E_UNLOCKED);
-            if (!is_local(bucket_base)) pool_->Deallocate<EList>(e);
-            if (oldBucketBase) pool_->Deallocate<PList>(curr, 1 << (depth - 1)); // deallocate if curr was not ours
-            return HT_Res<V>(FALSE_STATE, 0);
+    /// @brief Copy an EList without locking it
+    /// @param ptr the EList to read
+    /// @param out where to store the copy
+    /// @return false if the copy was torn by a concurrent writer and needs to be re-read
+    inline bool snapshot_elist(remote_elist ptr, EList& out){
+        if (is_local(ptr)){
+            out = *std::to_address(ptr);
+        } else {
+            remote_elist e = pool_->Read<EList>(ptr);
+            stats.bytes_read += sizeof(EList);
+            out = *std::to_address(e);
+            pool_->Deallocate<EList>(e);
         }
+        return out.is_consistent();
     }
-    
-    /// @brief Insert a key and value into the iht. Result will become the value at the key if already present.
-    /// @param key the key to insert
-    /// @param value the value to associate with the key
-    /// @return if the insert was successful
-    HT_Res<V> insert(K key, V value){
-        // start at root
-        remote_plist curr = pool_->Read<PList>(root);
-        remote_plist before_localized_curr = root;
-        size_t depth = 1, count = PLIST_SIZE;
-        bool oldBucketBase = true;
-        while (true){
-            uint64_t bucket = level_hash(key, depth, count);
-            if (!acquire(curr->buckets[bucket].lock)){
-                // Can't lock then we are at a sub-plist
-                // Therefore we must re-fetch the PList to ensure freshness of our pointers
-                remote_plist curr_temp = pool_->ExtendedRead<PList>(before_localized_curr, 1 << (depth - 1));
-                remote_plist bucket_base = static_cast<remote_plist>(curr_temp->buckets[bucket].base);
-                remote_plist base_ptr = is_local(bucket_base) || is_null(bucket_base) ? bucket_base : pool_->ExtendedRead<PList>(bucket_base, 1 << depth);
-                pool_->Deallocate<PList>(curr_temp, 1 << (depth - 1));
 
-                if (oldBucketBase) pool_->Deallocate<PList>(curr, 1 << (depth - 1)); // deallocate if curr was not ours
-                oldBucketBase = !is_local(bucket_base); // setting the old bucket base
+    /// @brief Read a remote EList into a copy, which must be deallocated
+    inline remote_elist read_elist(remote_elist ptr){
+        stats.bytes_read += sizeof(EList);
+        return pool_->Read<EList>(ptr);
+    }
 
-                before_localized_curr = bucket_base;
-                curr = base_ptr;
-                depth++;
-                count *= 2;
-                continue;
+    /// @brief Write back our copy of a remote EList, but only what readers look at: the first word, the tags and the live pairs.
+    /// It is still a single write, the prefix of the EList up to its last live pair. The slots past the count are left as they were.
+    /// A change to a single slot writes the header (first word, overflow and tags) and that slot's pair, which is one write if it is the first
+    /// @param touched the only slot that changed (an insert's new slot, or the one a remove swapped into), or ELIST_SIZE if any of them could have
+    inline void write_elist(remote_elist ptr, const EList &e, size_t touched = ELIST_SIZE){
+        // A moved EList is only its first word to readers
+        if (e.is_moved()){
+            write_word(meta_word(ptr), e.meta());
+        } else if (touched >= ELIST_SIZE){
+            write_prefix(ptr, e, std::make_index_sequence<ELIST_SIZE + 1>());
+        } else if (touched == 0 && e.count != 0){
+            write_bytes<live_bytes(1)>(ptr, e);
+        } else {
+            // Readers check the checksum, so seeing one write without the other is a torn read like any other
+            if (touched < e.count){
+                stats.bytes_written += sizeof(pair_t);
+                pool_->Write<pair_t>(remote_ptr<pair_t>(ptr.id(), ptr.address() + offsetof(EList, pairs) + sizeof(pair_t) * touched), e.pairs[touched]);
             }
+            write_bytes<live_bytes(0)>(ptr, e);
+        }
+    }
 
-            // We locked an elist, we can read the baseptr and progress
-            remote_elist bucket_base = static_cast<remote_elist>(curr->buckets[bucket].base);
-            remote_elist e = is_local(bucket_base) || is_null(bucket_base) ? bucket_base : pool_->Read<EList>(bucket_base);
-
-            // Past this point we have recursed to an elist
-            if (is_null(e)){
-                // empty elist
-                remote_elist e_new = pool_->Allocate<EList>();
-                e_new->elist_insert(key, value);
-                remote_baseptr e_base = static_cast<remote_baseptr>(e_new);
-                // modify the bucket's pointer
-                change_bucket_pointer(before_localized_curr, bucket, e_base);
-                unlock(curr->buckets[bucket].lock, E_UNLOCKED);
-                if (oldBucketBase) pool_->Deallocate<PList>(curr, 1 << (depth - 1)); // deallocate if curr was not ours
-                // successful insert
-                return HT_Res<V>(TRUE_STATE, 0);
-            }
-
-            // We have recursed to an non-empty elist
-            for (size_t i = 0; i < e->count; i++){
-                // Linear search to determine if elist already contains the key
-                if (e->pairs[i].key == key){
-                    K result = e->pairs[i].val;
-                    // Contains the key => unlock and return false
-                    unlock(curr->buckets[bucket].lock, E_UNLOCKED);
-                    if (bucket_base.id() != self_.id) pool_->Deallocate<EList>(e);
-                    if (oldBucketBase) pool_->Deallocate<PList>(curr, 1 << (depth - 1)); // deallocate if curr was not ours
-                    return HT_Res<V>(FALSE_STATE, result);
-                }
-            }
+    /// @brief The size of the prefix of an EList that holds n live pairs
+    static constexpr size_t live_bytes(size_t n){
+        return offsetof(EList, pairs) + sizeof(pair_t) * n;
+    }
 
-            // Check for enough insertion room
-            if (e->count < ELIST_SIZE) {
-                // insert, unlock, return
-                e->elist_insert(key, value);
-                // If we are modifying a local copy, we need to write to the remote at the end
-                if (bucket_base.id() != self_.id) pool_->Write<EList>(static_cast<remote_elist>(bucket_base), *e);
-                // unlock and return true
-                unlock(curr->buckets[bucket].lock, E_UNLOCKED);
-                if (bucket_base.id() != self_.id) pool_->Deallocate<EList>(e);
-                if (oldBucketBase) pool_->Deallocate<PList>(curr, 1 << (depth - 1)); // deallocate if curr was not ours
-                return HT_Res<V>(TRUE_STATE, 0);
-            }
+    /// @brief Pick the write of the prefix of an EList by its count. The pool writes whole objects, so each prefix size is a type of its own
+    template <size_t... N>
+    inline void write_prefix(remote_elist ptr, const EList &e, std::index_sequence<N...>){
+        ((e.count == N ? write_bytes<live_bytes(N)>(ptr, e) : void()), ...);
+    }
 
-            // Need more room so rehash into plist and perma-unlock
-            remote_plist p = rehash(curr, count, depth, bucket);
-            // modify the bucket's pointer
-            change_bucket_pointer(before_localized_curr, bucket, static_cast<remote_baseptr>(p));
-            // keep local curr updated with remote curr
-            curr->buckets[bucket].base = static_cast<remote_baseptr>(p);
-            // unlock bucket
-            unlock(curr->buckets[bucket].lock, P_UNLOCKED);
-            if (!is_local(bucket_base)) pool_->Deallocate<EList>(e);
-            // repeat from top in a way to progress past the plist we just inserted, without deallocating it.
-            oldBucketBase = false;
+    // The first bytes of an EList, as the pool writes them
+    template <size_t BYTES>
+    struct prefix_t {
+        uint8_t bytes[BYTES];
+    };
+
+    template <size_t BYTES>
+    inline void write_bytes(remote_elist ptr, const EList &e){
+        prefix_t<BYTES> prefix;
+        std::memcpy(prefix.bytes, &e, BYTES);
+        stats.bytes_written += BYTES;
+        pool_->Write<prefix_t<BYTES>>(remote_ptr<prefix_t<BYTES>>(ptr.id(), ptr.address()), prefix);
+    }
+
+    /// @brief Allocate an empty EList in our pool. Memory from the pool isn't constructed, so it might hold a previous EList
+    inline remote_elist allocate_elist(){
+        remote_elist e = pool_->Allocate<EList>();
+        *std::to_address(e) = EList();
+        return e;
+    }
+
+    /// @brief Find where to start a descent: the deepest plist on the key's path that is in the node's cache
+    /// @param hash the hash of the key being searched for
+    /// @param depth updated to the depth of the returned plist
+    /// @param count updated to the number of buckets in the returned plist
+    /// @param parent if not nullptr, set to the plist holding the bucket that points to the returned plist (remote_nullptr for the root)
+    /// @param parent_bucket if not nullptr, set to that bucket
+    /// @return the plist to start at
+    remote_plist cached_start(uint64_t hash, size_t &depth, size_t &count, remote_plist* parent = nullptr, uint64_t* parent_bucket = nullptr){
+        remote_plist p = local_root;
+        if (parent != nullptr) *parent = remote_nullptr;
+        if (cache_ == nullptr) return p;
+        // With compaction, a sub-plist can be freed once it is folded. Only entries made in the current epoch are sure to be alive
+        uint64_t min_epoch = compacting() ? reclaimer_->epoch() : 0;
+        while (true){
+            uint64_t bucket = level_hash(hash, depth, count);
+            remote_plist child = cache_->lookup(p, bucket, min_epoch);
+            if (is_null(child)) return p;
+            stats.plist_cache_hits++;
+            if (parent != nullptr) *parent = p;
+            if (parent_bucket != nullptr) *parent_bucket = bucket;
+            p = child;
+            depth++;
+            count = child_count(count);
         }
     }
-    
-    /// @brief Will remove a value at the key. Will stored the previous value in result.
-    /// @param key the key to remove at
-    /// @return if the remove was successful
-    HT_Res<V> remove(K key){
-        // start at root
-        remote_plist curr = pool_->Read<PList>(root);
-        remote_plist before_localized_curr = root;
-        size_t depth = 1, count = PLIST_SIZE;
-        bool oldBucketBase = true;
-        while (true) {
-            uint64_t bucket = level_hash(key, depth, count);
-            if (!acquire(curr->buckets[bucket].lock)){
-                // Can't lock then we are at a sub-plist
-                // Therefore we must re-fetch the PList to ensure freshness of our pointers (1 << depth-1 to adjust size of read with customized ExtendedRead)
-                remote_plist curr_temp = pool_->ExtendedRead<PList>(before_localized_curr, 1 << (depth - 1));
-                remote_plist bucket_base = static_cast<remote_plist>(curr_temp->buckets[bucket].base);
-                remote_plist base_ptr = is_local(bucket_base) || is_null(bucket_base) ? bucket_base : pool_->ExtendedRead<PList>(bucket_base, 1 << depth);
-                pool_->Deallocate<PList>(curr_temp, 1 << (depth - 1));
 
-                if (oldBucketBase) pool_->Deallocate<PList>(curr, 1 << (depth - 1)); // deallocate if curr was not ours
-                oldBucketBase = !is_local(bucket_base); // setting the old bucket base
+    /// @brief Cache the sub-plist of a permanently unlocked bucket, which we had to find remotely
+    inline void remember_plist(remote_plist parent, uint64_t bucket, remote_plist child){
+        if (cache_ == nullptr || is_null(child)) return;
+        stats.plist_cache_misses++;
+        // Stamped with our oldest operation's epoch, which is no later than the one the sub-plist would be retired in if it is folded
+        cache_->insert(parent, bucket, child, compacting() ? reclaimer_->oldest(reclaim_slot_) : 0);
+    }
 
-                before_localized_curr = bucket_base;
-                curr = base_ptr;
-                depth++;
-                count *= 2;
-                continue;
-            }
+    /// @brief Where a descent that reached a folded plist starts over: the root, without the cache (which might lead back to the folded plist)
+    inline remote_plist from_root(size_t &depth, size_t &count){
+        depth = 1;
+        count = root_count;
+        return local_root;
+    }
 
-            // We locked an elist, we can read the baseptr and progress
-            remote_elist bucket_base = static_cast<remote_elist>(curr->buckets[bucket].base);
-            remote_elist e = is_local(bucket_base) || is_null(bucket_base) ? bucket_base : pool_->Read<EList>(bucket_base);
+    static_assert((CNF_GROWTH_CAP & (CNF_GROWTH_CAP - 1)) == 0, "Plists are PLIST_SIZE times a power of two buckets");
 
-            // Past this point we have recursed to an elist
-            if (is_null(e)){
-                // empty elist, can just unlock and return false
-                unlock(curr->buckets[bucket].lock, E_UNLOCKED);
-                if (oldBucketBase) pool_->Deallocate<PList>(curr, 1 << (depth - 1)); // deallocate if curr was not ours
-                return HT_Res<V>(FALSE_STATE, 0);
-            }
+    /// @brief The number of buckets of the plist that a full elist of a plist with count buckets is split into
+    inline size_t child_count(size_t count){
+        switch (config_.growth){
+        case Growth::CONSTANT:
+            return PLIST_SIZE;
+        case Growth::CAPPED:
+            return std::min(count * 2, (size_t) PLIST_SIZE * CNF_GROWTH_CAP);
+        default:
+            return count * 2;
+        }
+    }
 
-            // Get elist and linear search
-            for (size_t i = 0; i < e->count; i++){
-                // Linear search to determine if elist already contains the value
-                if (e->pairs[i].key == key){
-                    K result = e->pairs[i].val; // saving the previous value at key
-                    if (e->count > 1){
-                        // Edge swap if not count=0|1
-                        e->pairs[i] = e->pairs[e->count - 1];
-                    }
-                    e->count -= 1;
-                    // If we are modifying the local copy, we need to write to the remote at the end...
-                    if (!is_local(bucket_base)) pool_->Write<EList>(static_cast<remote_elist>(bucket_base), *e);
-                    // Unlock and return
-                    unlock(curr->buckets[bucket].lock, E_UNLOCKED);
-                    if (!is_local(bucket_base)) pool_->Deallocate<EList>(e);
-                    if (oldBucketBase) pool_->Deallocate<PList>(curr, 1 << (depth - 1)); // deallocate if curr was not ours
-                    return HT_Res<V>(TRUE_STATE, result);
-                }
-            }
+    /// @brief The number of buckets to give root for a number of keys, so that a key is expected to be found in the root's elists
+    /// (or in those of the first level, if every root bucket starts with a sub-plist). Bounded by CNF_ROOT_MAX_FACTOR
+    size_t root_size_for(size_t expected_keys, bool presplit){
+        // Elists half full at the expected load, so few of them fill up and split
+        size_t buckets = expected_keys * 2 / ELIST_SIZE;
+        size_t count = PLIST_SIZE;
+        while (count < (size_t) PLIST_SIZE * CNF_ROOT_MAX_FACTOR && (presplit ? count * child_count(count) : count) < buckets) count *= 2;
+        return count;
+    }
 
-            // Can't find, unlock and return false
-            unlock(curr->buckets[bucket].lock, E_UNLOCKED);
-            if (!is_local(bucket_base)) pool_->Deallocate<EList>(e);
-            if (oldBucketBase) pool_->Deallocate<PList>(curr, 1 << (depth - 1)); // deallocate if curr was not ours
-            return HT_Res<V>(FALSE_STATE, 0);
+    /// @brief If the buckets of a plist at a depth chain their full elists instead of splitting them
+    inline bool at_max_depth(size_t depth){
+        return config_.max_depth != 0 && depth >= config_.max_depth;
+    }
+
+    // Hashing function to decide bucket size, from the hash of the key
+    inline uint64_t level_hash(uint64_t hash, size_t level, size_t count){
+        return hasher_.bucket(hash, level, count);
+    }
+
+    /// @brief The hash of the key of a pair. A payload pair keeps it, so its payload isn't fetched
+    inline uint64_t hash_of(const pair_t &p){
+        if constexpr (EList::INLINE) return hasher_.hash(p.key);
+        else return p.fingerprint;
+    }
+
+    /// @brief The number of words a payload takes up. At least two, so the reclaimer has room to ship it back to its owner
+    static inline size_t payload_words(size_t bytes){
+        return std::max<size_t>(2, (bytes + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    }
+
+    /// @brief Make the pair to insert for a key and value. A pair that isn't stored inline gets a payload in our pool
+    pair_t make_pair(const K &key, uint64_t hash, const V &value){
+        if constexpr (EList::INLINE){
+            return {key, value};
+        } else {
+            size_t key_len = PayloadCodec<K>::size(key), val_len = PayloadCodec<V>::size(value);
+            remote_ptr<uint64_t> payload = pool_->Allocate<uint64_t>(payload_words(key_len + val_len));
+            uint8_t* bytes = reinterpret_cast<uint8_t*>(std::to_address(payload));
+            PayloadCodec<K>::encode(key, bytes);
+            PayloadCodec<V>::encode(value, bytes + key_len);
+            return {hash, pack_ptr(payload), (uint32_t) key_len, (uint32_t) val_len};
         }
     }
 
-    /// Function signature added to match map interface. No intermediary cleanup necessary so unusued
-    void try_rehash(){
-        // Unused function b/c no cleanup necessary
+    /// @brief Fetch the payload of a pair and check if it holds a key. Payloads are never modified, so no lock or checksum is needed
+    /// @param p the pair, whose fingerprint matched
+    /// @param key the key being searched for
+    /// @param val updated to the value of the pair if it holds key
+    /// @return if the pair holds key
+    bool match_payload(const typename EList::payload_pair_t &p, const K &key, V &val){
+        remote_ptr<uint64_t> payload = unpack_ptr<uint64_t>(p.payload);
+        size_t words = payload_words(p.key_len + p.val_len);
+        remote_ptr<uint64_t> copy = payload;
+        if (!is_local(payload)){
+            copy = pool_->ExtendedRead<uint64_t>(payload, words);
+            stats.bytes_read += words * sizeof(uint64_t);
+        }
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(std::to_address(copy));
+        bool match = PayloadCodec<K>::decode(bytes, p.key_len) == key;
+        if (match) val = PayloadCodec<V>::decode(bytes + p.key_len, p.val_len);
+        if (!is_local(payload)) pool_->Deallocate<uint64_t>(copy, words);
+        return match;
     }
 
-    /// @brief Populate only works when we have numerical keys. Will add data
-    /// @param count the number of values to insert. Recommended in total to do key_range / 2
-    /// @param key_lb the lower bound for the key range
-    /// @param key_ub the upper bound for the key range
-    /// @param value the value to associate with each key. Currently, we have asserts for result to be equal to the key. Best to set value equal to key!
-    void populate(int op_count, K key_lb, K key_ub, std::function<K(V)> value){
-        // Populate only works when we have numerical keys
-        K key_range = key_ub - key_lb;
+    /// @brief The tag of a key in an elist, from the hash of the key. The hash is mixed first since std::hash can be the identity
+    static inline uint8_t tag_of(uint64_t hash){
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+        return hash >> 56;
+    }
 
-        // Create a random operation generator that is 
-        // - evenly distributed among the key range
-        std::uniform_real_distribution<double> dist = std::uniform_real_distribution<double>(0.0, 1.0);
-        std::default_random_engine gen((unsigned) std::time(NULL));
-        for (int c = 0; c < op_count; c++){
-            int k = dist(gen) * key_range + key_lb;
-            insert(k, value(k));
-            // Wait some time before doing next insert...
-            std::this_thread::sleep_for(std::chrono::nanoseconds(10));
+    /// @brief Search an elist for a key. Only the pairs whose tag matches are compared
+    /// @param e the elist to search
+    /// @param key the key to search for
+    /// @param hash the hash of key
+    /// @param val updated to the value at the key, if it is found
+    /// @return the index of the key, or e.count if the elist doesn't contain it
+    size_t find_key(const EList &e, const K &key, uint64_t hash, V &val){
+        for (uint64_t m = e.match_tags(tag_of(hash)); m != 0; m &= m - 1){
+            size_t i = std::countr_zero(m);
+            if (pair_matches(e.pairs[i], key, hash, val)) return i;
+        }
+        return e.count;
+    }
+
+    /// @brief Search the inline pairs of a bucket for a key. There are only a few, so their tags are compared one at a time
+    /// @return if the key was found, in which case val is updated to its value
+    bool find_inline(const InlinePairs &pairs, const K &key, uint64_t hash, V &val){
+        uint8_t t = tag_of(hash);
+        for (size_t i = 0; i < pairs.count; i++){
+            if (pairs.tags[i] == t && pair_matches(pairs.pairs[i], key, hash, val)) return true;
+        }
+        return false;
+    }
+
+    /// @brief If a pair whose tag matched holds a key
+    inline bool pair_matches(const pair_t &p, const K &key, uint64_t hash, V &val){
+        if constexpr (EList::INLINE){
+            if (p.key != key) return false;
+            val = p.val;
+            return true;
+        } else {
+            return p.fingerprint == hash && match_payload(p, key, val);
+        }
+    }
+
+    /// @brief Insert a key and value into an elist that has room for it
+    inline void insert_pair(remote_elist e, const K &key, uint64_t hash, const V &value){
+        e->elist_insert(make_pair(key, hash, value), tag_of(hash));
+    }
+
+    /// @brief Remove the pair at index i of an elist. Its payload (if it has one) is retired, since lock-free readers might still be reading it
+    inline void remove_pair(remote_elist e, size_t i){
+        if constexpr (!EList::INLINE){
+            retire(unpack_ptr<uint64_t>(e->pairs[i].payload), payload_words(e->pairs[i].key_len + e->pairs[i].val_len));
+        }
+        e->elist_remove(i);
+    }
+
+    /// Rehash function
+    /// @param parent_bucket The full E-List (of a locked bucket) that needs rehashing
+    /// @param source The caller's copy of parent_bucket (or parent_bucket itself if it is local)
+    /// @param pcount The number of elements in the P-List holding the bucket
+    /// @param pdepth The depth of the P-List holding the bucket
+    remote_plist rehash(remote_elist parent_bucket, remote_elist source, size_t pcount, size_t pdepth){
+        pcount = child_count(pcount);
+        int plist_size_factor = (pcount / PLIST_SIZE); // how much bigger than original size we are
+        remote_plist new_p = pool_->Allocate<PList>(plist_size_factor);
+        InitPList(new_p, plist_size_factor);
+
+        // hash everything from the full elist into it
+        for (size_t i = 0; i < source->count; i++){
+            uint64_t b = level_hash(hash_of(source->pairs[i]), pdepth + 1, pcount);
+            place_pair(new_p, b, source->pairs[i], source->tags[i]);
+        }
+        uint64_t hint = hash_of(source->pairs[0]);
+        // Tell lock-free readers with a stale pointer that the elist is gone
+        source->mark_moved();
+        if (!is_local(parent_bucket)) write_elist(parent_bucket, *source);
+        // Built in our pool, and moved to where it belongs before anyone can see it
+        return settle_plist(new_p, plist_size_factor, hint);
+    }
+
+    /// @brief Replace the full elist of a locked bucket with a plist of its contents, and perma-unlock the bucket
+    /// @param curr the plist holding the bucket
+    /// @param bucket the bucket to split
+    /// @param bucket_base the full elist
+    /// @param e our copy of the elist (bucket_base itself if it is local)
+    /// @param count the number of buckets in curr
+    /// @param depth the depth of curr
+    /// @return the new plist
+    remote_plist split_bucket(remote_plist curr, uint64_t bucket, remote_elist bucket_base, remote_elist e, size_t count, size_t depth){
+        if (config_.offload_splits && !is_local(bucket_base)){
+            remote_plist p = offload_split(curr, bucket, bucket_base, count, depth);
+            if (!is_null(p)) return p;
+        }
+        remote_plist p = rehash(bucket_base, e, count, depth);
+        // modify the bucket's pointer and perma-unlock it
+        change_bucket_pointer(curr, bucket, static_cast<remote_baseptr>(p), P_UNLOCKED);
+        // Nothing leads to the elist anymore, but lock-free readers might still be reading it
+        retire(bucket_base);
+        remember_plist(curr, bucket, p);
+        return p;
+    }
+
+    /// @brief The bytes of an object of a size class of the stock
+    static constexpr size_t stock_bytes(int c){
+        return c == 0 ? sizeof(EList) : sizeof(PList) << (c - 1);
+    }
+
+    /// @brief The slot of a stock that holds an object of a size class
+    inline remote_ptr<uint64_t> stock_slot(remote_ptr<PlacementStock> stock, int c, int i){
+        return remote_ptr<uint64_t>(stock.id(), stock.address() + offsetof(PlacementStock, rows) + sizeof(PlacementStock::row_t) * c + sizeof(uint64_t) * i);
+    }
+
+    /// @brief Allocate an object of a size class of the stock in our pool
+    uint64_t stock_object(int c){
+        if (c == 0) return pack_ptr(pool_->Allocate<EList>());
+        return pack_ptr(pool_->Allocate<PList>(1 << (c - 1)));
+    }
+
+    /// @brief Give back an object of stock_object that didn't make it into the stock
+    void unstock_object(int c, uint64_t obj){
+        if (c == 0) pool_->Deallocate<EList>(unpack_ptr<EList>(obj));
+        else pool_->Deallocate<PList>(unpack_ptr<PList>(obj), 1 << (c - 1));
+    }
+
+    /// @brief Make our peer's stock of objects for others to place here, and register it in the header. Threads sharing our pool share the stock
+    void register_stock(){
+        if (self_.id >= MAX_REPLICAS){
+            ROME_INFO("Warning: Peer {} is past MAX_REPLICAS and won't hold objects for others", self_.id);
+            return;
+        }
+        remote_ptr<uint64_t> entry = remote_ptr<uint64_t>(header.id(), header.address() + offsetof(Header, stocks) + sizeof(uint64_t) * self_.id);
+        remote_ptr<PlacementStock> stock = pool_->Allocate<PlacementStock>();
+        stock->used = 0;
+        for (int c = 0; c < PlacementStock::CLASSES; c++){
+            for (int i = 0; i < CNF_STOCK_SIZE; i++) stock->rows[c].slots[i] = stock_object(c);
+        }
+        uint64_t prev = pool_->CompareAndSwap<uint64_t>(entry, 0, pack_ptr(stock));
+        if (prev != 0){
+            // Another thread on our pool registered first
+            for (int c = 0; c < PlacementStock::CLASSES; c++){
+                for (int i = 0; i < CNF_STOCK_SIZE; i++) unstock_object(c, stock->rows[c].slots[i]);
+            }
+            pool_->Deallocate<PlacementStock>(stock);
+            stock = unpack_ptr<PlacementStock>(prev);
+        }
+        stock_ = stock;
+    }
+
+    /// @brief Refill the slots of our stock that other peers took an object from. What they took counts as handed out
+    void refill_stock(){
+        if (is_null(stock_)) return;
+        for (int c = 0; c < PlacementStock::CLASSES; c++){
+            for (int i = 0; i < CNF_STOCK_SIZE; i++){
+                remote_ptr<uint64_t> slot = stock_slot(stock_, c, i);
+                if (read_word(slot) != 0) continue;
+                uint64_t obj = stock_object(c);
+                if (cas_word(slot, 0, obj) != 0){
+                    // Another thread of ours refilled it
+                    unstock_object(c, obj);
+                    continue;
+                }
+                std::atomic_ref<uint64_t>(stock_->used).fetch_add(stock_bytes(c));
+            }
+        }
+    }
+
+    /// @brief Read which peers keep a stock, and with LEAST_LOADED how much each has handed out
+    void refresh_placement(){
+        if (!is_local(header)) stats.bytes_read += sizeof(Header);
+        remote_header h = is_local(header) ? header : pool_->Read<Header>(header);
+        placement_peers_.clear();
+        for (int i = 0; i < MAX_REPLICAS; i++){
+            stocks_[i] = h->stocks[i];
+            if (stocks_[i] != 0) placement_peers_.push_back(i);
+        }
+        if (!is_local(header)) pool_->Deallocate<Header>(h);
+        if (config_.placement != Placement::LEAST_LOADED) return;
+        for (uint16_t peer : placement_peers_){
+            remote_ptr<PlacementStock> stock = unpack_ptr<PlacementStock>(stocks_[peer]);
+            loads_[peer] = read_word(remote_ptr<uint64_t>(stock.id(), stock.address() + offsetof(PlacementStock, used)));
+        }
+    }
+
+    /// @brief The peer the placement policy puts an object in
+    /// @param hint the hash of the first key the object holds
+    uint16_t placement_peer(uint64_t hint){
+        if (placements_++ % CNF_PLACEMENT_REFRESH == 0 || placement_peers_.empty()) refresh_placement();
+        if (placement_peers_.empty()) return self_.id;
+        switch (config_.placement){
+        case Placement::ROUND_ROBIN:
+            return placement_peers_[(self_.id + next_peer_++) % placement_peers_.size()];
+        case Placement::HASH_HOME:
+            return placement_peers_[hint % placement_peers_.size()];
+        case Placement::LEAST_LOADED: {
+            uint16_t best = placement_peers_[0];
+            for (uint16_t peer : placement_peers_){
+                if (loads_[peer] < loads_[best]) best = peer;
+            }
+            return best;
+        }
+        default:
+            return self_.id;
+        }
+    }
+
+    /// @brief Take an object of a size class from the stock of another peer
+    /// @return the object, or 0 if the stock is out
+    uint64_t take_from_stock(uint16_t peer, int c){
+        remote_ptr<PlacementStock> stock = unpack_ptr<PlacementStock>(stocks_[peer]);
+        typedef typename PlacementStock::row_t row_t;
+        remote_ptr<row_t> at = remote_ptr<row_t>(stock.id(), stock.address() + offsetof(PlacementStock, rows) + sizeof(row_t) * c);
+        remote_ptr<row_t> red = pool_->Read<row_t>(at);
+        stats.bytes_read += sizeof(row_t);
+        row_t row = *std::to_address(red);
+        pool_->Deallocate<row_t>(red);
+        for (int i = 0; i < CNF_STOCK_SIZE; i++){
+            // Whatever the slot held before, an object we CAS out of it is ours
+            if (row.slots[i] != 0 && cas_word(stock_slot(stock, c, i), row.slots[i], 0) == row.slots[i]) return row.slots[i];
+        }
+        return 0;
+    }
+
+    /// @brief Find room for a plist or elist of the table in another peer, if the placement policy puts it there
+    /// @param c the size class of the object
+    /// @param hint the hash of the first key the object holds
+    /// @return the room, or 0 if the object stays in our pool
+    uint64_t place_remote(int c, uint64_t hint){
+        uint16_t peer = placement_peer(hint);
+        if (peer != self_.id){
+            uint64_t obj = take_from_stock(peer, c);
+            if (obj != 0){
+                stats.placed_remote++;
+                count_placed(peer, stock_bytes(c));
+                return obj;
+            }
+            stats.placement_fallbacks++;
+        }
+        if (!is_null(stock_)) std::atomic_ref<uint64_t>(stock_->used).fetch_add(stock_bytes(c));
+        count_placed(self_.id, stock_bytes(c));
+        return 0;
+    }
+
+    /// @brief Until the next refresh, count what we placed in a peer in its load, so we don't all pile on one peer.
+    /// Only the peer the object actually landed in is charged, not the one the policy picked if its stock was out
+    inline void count_placed(uint16_t peer, size_t bytes){
+        if (config_.placement == Placement::LEAST_LOADED && peer < MAX_REPLICAS) loads_[peer] += bytes;
+    }
+
+    /// @brief Move an elist built in our pool to where the placement policy puts it. Must not be reachable yet
+    /// @return where the elist is now
+    remote_elist settle_elist(remote_elist e){
+        if (config_.placement == Placement::LOCAL || e->count == 0) return e;
+        remote_elist at = unpack_ptr<EList>(place_remote(0, hash_of(e->pairs[0])));
+        if (is_null(at)) return e;
+        write_elist(at, *e);
+        pool_->Deallocate<EList>(e);
+        return at;
+    }
+
+    /// @brief Move a plist built in our pool, and the elists of its buckets, to where the placement policy puts them. Must not be reachable yet
+    /// @param factor how many times PLIST_SIZE buckets it has
+    /// @param hint the hash of a key it holds
+    /// @return where the plist is now
+    remote_plist settle_plist(remote_plist p, int factor, uint64_t hint){
+        if (config_.placement == Placement::LOCAL) return p;
+        for (size_t i = 0; i < static_cast<size_t>(PLIST_SIZE) * factor; i++){
+            bucket_t &b = local_bucket(p, i);
+            if (is_null(base_of(b))) continue;
+            b = make_bucket(static_cast<remote_baseptr>(settle_elist(static_cast<remote_elist>(base_of(b)))), state_of(b));
+        }
+        // Only plists up to the largest size class are kept in stock
+        int c = 1 + std::countr_zero(static_cast<unsigned>(factor));
+        if (c >= PlacementStock::CLASSES) return p;
+        remote_plist at = unpack_ptr<PList>(place_remote(c, hint));
+        if (is_null(at)) return p;
+        for (int k = 0; k < factor; k++){
+            pool_->Write<PList>(remote_plist(at.id(), at.address() + sizeof(PList) * k), std::to_address(p)[k]);
+        }
+        stats.bytes_written += sizeof(PList) * factor;
+        pool_->Deallocate<PList>(p, factor);
+        return at;
+    }
+
+    /// @brief Register our peer's inbox of splits in the header. Threads sharing our pool share the inbox
+    void register_split_inbox(){
+        if (self_.id >= MAX_REPLICAS){
+            ROME_INFO("Warning: Peer {} is past MAX_REPLICAS and won't split elists for others", self_.id);
+            return;
+        }
+        remote_ptr<uint64_t> entry = remote_ptr<uint64_t>(header.id(), header.address() + offsetof(Header, split_inboxes) + sizeof(uint64_t) * self_.id);
+        remote_ptr<uint64_t> inbox = pool_->Allocate<uint64_t>();
+        *std::to_address(inbox) = 0;
+        uint64_t prev = pool_->CompareAndSwap<uint64_t>(entry, 0, pack_ptr(inbox));
+        if (prev != 0){
+            // Another thread on our pool registered first
+            pool_->Deallocate<uint64_t>(inbox, 8);
+            inbox = unpack_ptr<uint64_t>(prev);
+        }
+        split_inbox_ = inbox;
+    }
+
+    /// @brief The inbox of splits of a peer. 0 if it takes none
+    uint64_t split_inbox_of(uint16_t peer){
+        if (peer >= MAX_REPLICAS) return 0;
+        if (split_inboxes_[peer] == 0){
+            // An inbox never changes once registered, so only a missing one is read again
+            remote_ptr<uint64_t> entry = remote_ptr<uint64_t>(header.id(), header.address() + offsetof(Header, split_inboxes) + sizeof(uint64_t) * peer);
+            split_inboxes_[peer] = read_word(entry);
+        }
+        return split_inboxes_[peer];
+    }
+
+    /// @brief Ship the split of a full elist of another peer to that peer, which splits it in its own memory and unlocks the bucket.
+    /// Must hold the bucket's lock. Waits for the owner, serving our own inbox meanwhile, so two peers waiting on each other both make progress
+    /// @return the sub-plist, or remote_nullptr if the owner takes no splits or didn't take this one in time. The bucket is still locked then
+    remote_plist offload_split(remote_plist curr, uint64_t bucket, remote_elist bucket_base, size_t count, size_t depth){
+        free_cancelled_splits();
+        uint64_t inbox = split_inbox_of(bucket_base.id());
+        if (inbox == 0) return remote_nullptr;
+        remote_split req = pool_->Allocate<split_req_t>();
+        remote_plist at = config_.replicate_root && curr == local_root ? root : curr;
+        *std::to_address(req) = split_req_t{0, SPLIT_PENDING, pack_ptr(at), bucket, pack_ptr(bucket_base), count, depth};
+        remote_ptr<uint64_t> head_ptr = unpack_ptr<uint64_t>(inbox);
+        remote_ptr<uint64_t> state = remote_ptr<uint64_t>(req.id(), req.address() + offsetof(split_req_t, state));
+        uint64_t head = 0;
+        while (true){
+            // Link the request in front of the head we last saw, then try to swing the head to it
+            std::atomic_ref<uint64_t>(std::to_address(req)->next).store(head, std::memory_order_release);
+            uint64_t v = cas_word(head_ptr, head, pack_ptr(req));
+            if (v == head) break;
+            head = v;
+        }
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(CNF_SPLIT_WAIT_NS);
+        uint64_t s;
+        while ((s = read_word(state)) == SPLIT_PENDING || s == SPLIT_TAKEN){
+            serve_splits();
+            if (s == SPLIT_PENDING && std::chrono::steady_clock::now() > deadline){
+                // Take it back. The owner might take it at the same time, and then it is the owner's
+                s = cas_word(state, SPLIT_PENDING, SPLIT_CANCELLED);
+                if (s == SPLIT_PENDING){
+                    stats.split_timeouts++;
+                    cancelled_splits_.push_back(req);
+                    return remote_nullptr;
+                }
+            }
+        }
+        pool_->Deallocate<split_req_t>(req);
+        // The owner unlocked the bucket for us. If we hold it through a cohort, nothing is left to pass on
+        uint64_t addr = pack_ptr(lock_slot(curr, bucket));
+        if (cohort_slot_ == addr){
+            cohort_slot_ = 0;
+            cohort_->leave(addr);
+        }
+        remote_plist p = unpack_ptr<PList>(s);
+        remember_plist(curr, bucket, p);
+        stats.splits_offloaded++;
+        return p;
+    }
+
+    /// @brief Free the requests we gave up on that their owner has dropped since
+    void free_cancelled_splits(){
+        size_t kept = 0;
+        for (remote_split req : cancelled_splits_){
+            if (std::atomic_ref<uint64_t>(std::to_address(req)->state).load(std::memory_order_acquire) == SPLIT_DROPPED) pool_->Deallocate<split_req_t>(req);
+            else cancelled_splits_[kept++] = req;
+        }
+        cancelled_splits_.resize(kept);
+    }
+
+    /// @brief Do what other peers need of ours before an operation: the splits they shipped us (an inserter holds its bucket until we are done),
+    /// and the objects they took from our stock
+    inline void serve_peers(){
+        serve_splits();
+        refill_stock();
+    }
+
+    /// @brief Do the splits other peers shipped to our peer. Each elist is ours, so it is split with local accesses, and the bucket is unlocked for its inserter
+    void serve_splits(){
+        if (is_null(split_inbox_)) return;
+        // Others push with RDMA atomics, so we have to take the list with one too
+        uint64_t head = read_word(split_inbox_);
+        while (head != 0){
+            uint64_t v = cas_word(split_inbox_, head, 0);
+            if (v == head) break;
+            head = v;
+        }
+        while (head != 0){
+            remote_split at = unpack_ptr<split_req_t>(head);
+            remote_split red = pool_->Read<split_req_t>(at);
+            stats.bytes_read += sizeof(split_req_t);
+            split_req_t req = *std::to_address(red);
+            pool_->Deallocate<split_req_t>(red);
+            head = req.next;
+            remote_ptr<uint64_t> state = remote_ptr<uint64_t>(at.id(), at.address() + offsetof(split_req_t, state));
+            if (cas_word(state, SPLIT_PENDING, SPLIT_TAKEN) != SPLIT_PENDING){
+                // The inserter gave up on it, and can free it now that we are done with it
+                write_word(state, SPLIT_DROPPED);
+                continue;
+            }
+            remote_plist curr = unpack_ptr<PList>(req.curr);
+            if (config_.replicate_root && curr == root) curr = local_root;
+            remote_elist e = unpack_ptr<EList>(req.elist);
+            remote_plist p = split_bucket(curr, req.bucket, e, e, req.count, req.depth);
+            write_word(state, pack_ptr(p));
+            stats.splits_served++;
+        }
+    }
+
+    /// @brief Add a pair to a bucket of a plist no one else can see yet. It goes in the bucket itself while there is room, and spills to an elist after
+    void place_pair(remote_plist p, uint64_t bucket, const pair_t &pair, uint8_t tag){
+        bucket_t &b = local_bucket(p, bucket);
+        if (is_null(base_of(b))){
+            if constexpr (BUCKET_PAIRS > 0){
+                InlinePairs &pairs = local_pairs(p, bucket);
+                if (pairs.count < BUCKET_PAIRS){
+                    pairs.tags[pairs.count] = tag;
+                    pairs.pairs[pairs.count] = pair;
+                    pairs.count++;
+                    seal_pairs(0, pairs);
+                    return;
+                }
+            }
+            remote_elist e = allocate_elist();
+            if constexpr (BUCKET_PAIRS > 0){
+                InlinePairs &pairs = local_pairs(p, bucket);
+                for (size_t i = 0; i < pairs.count; i++) e->elist_insert(pairs.pairs[i], pairs.tags[i]);
+                pairs = InlinePairs();
+                seal_pairs(pack_ptr(e), pairs);
+            }
+            b = make_bucket(static_cast<remote_baseptr>(e), E_UNLOCKED);
+        }
+        static_cast<remote_elist>(base_of(b))->elist_insert(pair, tag);
+    }
+
+    /// @brief A pair of a bulk load, by its index in the source
+    struct load_t {
+        size_t idx;
+        uint64_t hash; // The hash of the key
+    };
+
+    /// @brief Build the subtree of a bucket in our pool, without any remote operation. It has the shape inserting the pairs one at a time would give:
+    /// an elist if they fit in one, otherwise a plist of child_count buckets with the pairs hashed into it (the buckets of which hold a few pairs themselves).
+    /// At the max depth, a chain of elists
+    /// @param pairs the pairs that go to the bucket. The keys must be distinct
+    /// @param count the number of buckets in the plist holding the bucket
+    /// @param depth the depth of the plist holding the bucket
+    /// @param held set to the pairs the bucket holds itself, when they are few enough to, sealed for the bucket returned
+    /// @return the bucket pointing to the subtree, unlocked
+    bucket_t build_subtree(const std::vector<load_t> &pairs, std::span<const K> keys, std::span<const V> values, size_t count, size_t depth, InlinePairs &held){
+        if constexpr (BUCKET_PAIRS > 0){
+            if (pairs.size() <= BUCKET_PAIRS){
+                held = InlinePairs();
+                for (const load_t &l : pairs){
+                    held.tags[held.count] = tag_of(l.hash);
+                    held.pairs[held.count] = make_pair(keys[l.idx], l.hash, values[l.idx]);
+                    held.count++;
+                }
+                seal_pairs(0, held);
+                return make_bucket(remote_nullptr, E_UNLOCKED);
+            }
+        }
+        if (pairs.size() <= ELIST_SIZE || at_max_depth(depth)){
+            // A bucket at the max depth gets a chain of elists instead
+            remote_elist e = remote_nullptr;
+            for (size_t i = 0; i < pairs.size(); i += ELIST_SIZE){
+                remote_elist link = allocate_elist();
+                for (size_t j = i; j < std::min(i + ELIST_SIZE, pairs.size()); j++) insert_pair(link, keys[pairs[j].idx], pairs[j].hash, values[pairs[j].idx]);
+                if (pairs.size() > ELIST_SIZE) link->reserved |= EList::CLOSED;
+                link->overflow = is_null(e) ? 0 : pack_ptr(e);
+                link->seal();
+                e = link;
+            }
+            return make_bucket(static_cast<remote_baseptr>(e), E_UNLOCKED);
+        }
+        count = child_count(count);
+        int plist_size_factor = count / PLIST_SIZE;
+        remote_plist p = pool_->Allocate<PList>(plist_size_factor);
+        InitPList(p, plist_size_factor);
+        // A deep plist is mostly empty, so only the buckets that are used are gathered
+        std::unordered_map<uint64_t, std::vector<load_t>> children;
+        for (const load_t &l : pairs) children[level_hash(l.hash, depth + 1, count)].push_back(l);
+        for (auto &[b, child] : children){
+            if (child.size() > ELIST_SIZE){
+                // Too many pairs for the bucket to hold any itself
+                InlinePairs none;
+                local_bucket(p, b) = build_subtree(child, keys, values, count, depth + 1, none);
+                continue;
+            }
+            for (const load_t &l : child) place_pair(p, b, make_pair(keys[l.idx], l.hash, values[l.idx]), tag_of(l.hash));
+        }
+        return make_bucket(static_cast<remote_baseptr>(p), P_UNLOCKED);
+    }
+
+    /// @brief Load the pairs of a bucket of bulk_load. An empty bucket gets a subtree built in our pool, published with a single write.
+    /// A sub-plist is descended into, loading each of its buckets the same way. Pairs going to a bucket that holds some already are inserted one at a time
+    /// @param pairs the pairs that go to the bucket. The keys must be distinct
+    /// @param count the number of buckets in curr
+    /// @param depth the depth of curr
+    /// @return the number of pairs that were loaded
+    size_t load_bucket(remote_plist curr, uint64_t bucket, const std::vector<load_t> &pairs, std::span<const K> keys, std::span<const V> values, size_t count, size_t depth){
+        remote_bucket slot = lock_slot(curr, bucket);
+        bucket_t b = read_bucket(curr, bucket);
+        bool locked = acquire(slot, b);
+        if (locked && is_null(base_of(b)) && read_pairs(slot).count == 0){
+            // Build under the lock. It only touches our own memory, so the bucket isn't held for long
+            InlinePairs held;
+            bucket_t sub = build_subtree(pairs, keys, values, count, depth, held);
+            if constexpr (BUCKET_PAIRS > 0){
+                if (held.count != 0) write_pairs(curr, bucket, base_of(sub), held);
+            }
+            change_bucket_pointer(curr, bucket, base_of(sub), state_of(sub));
+            return pairs.size();
+        }
+        if (!locked && state_of(b) == P_UNLOCKED){
+            remote_plist p = static_cast<remote_plist>(base_of(b));
+            count = child_count(count);
+            std::unordered_map<uint64_t, std::vector<load_t>> children;
+            for (const load_t &l : pairs) children[level_hash(l.hash, depth + 1, count)].push_back(l);
+            size_t loaded = 0;
+            for (auto &[child, child_pairs] : children) loaded += load_bucket(p, child, child_pairs, keys, values, count, depth + 1);
+            return loaded;
+        }
+        // The bucket already has pairs (or was folded), merge with them through the normal protocol
+        if (locked) unlock(slot, b);
+        std::vector<K> merge_keys;
+        std::vector<V> merge_values;
+        for (const load_t &l : pairs){
+            merge_keys.push_back(keys[l.idx]);
+            merge_values.push_back(values[l.idx]);
+        }
+        size_t loaded = 0;
+        for (const HT_Res<V> &r : insert_batch(merge_keys, merge_values)){
+            if (r.status == TRUE_STATE) loaded++;
+        }
+        return loaded;
+    }
+
+    /// @brief If the elist of a locked bucket can be unlinked once it is empty. A bucket without one has nothing to unlink, and without a reclaimer it would just leak
+    inline bool can_unlink(remote_elist bucket_base, remote_elist e){
+        return !is_null(bucket_base) && e->count == 0 && e->overflow == 0 && reclaimer_ != nullptr;
+    }
+
+    /// @brief Unlink the empty elist of a locked bucket, which unlocks the bucket
+    inline void unlink_elist(remote_plist curr, uint64_t bucket, remote_elist bucket_base){
+        // The pairs the bucket had before it spilled are long gone
+        if constexpr (BUCKET_PAIRS > 0) write_pairs(curr, bucket, remote_nullptr, InlinePairs());
+        change_bucket_pointer(curr, bucket, remote_nullptr, E_UNLOCKED);
+        retire(bucket_base);
+    }
+
+    /// @brief If removes fold the sub-plists they leave sparse. A folded plist has to be retired, so it takes a reclaimer
+    inline bool compacting(){
+        return config_.compact_threshold != 0 && reclaimer_ != nullptr;
+    }
+
+    /// @brief Fold a sub-plist back into its parent's bucket if it holds at most compact_threshold pairs and no sub-plists.
+    /// Every bucket of the plist is locked, in order, so two folds of it can't deadlock. Its elists are marked moved for lock-free readers,
+    /// the parent's bucket gets the pairs (in an elist, or in the bucket itself if they fit), and the buckets of the plist are left FOLDED
+    /// for the operations that still reach it. The plist and its elists are retired
+    /// @param parent the plist holding the bucket that points to p
+    /// @param parent_bucket that bucket
+    /// @param p the sub-plist
+    /// @param count the number of buckets in p
+    /// @return if p was folded
+    bool fold_plist(remote_plist parent, uint64_t parent_bucket, remote_plist p, size_t count){
+        size_t limit = std::min<size_t>(config_.compact_threshold, ELIST_SIZE);
+        int factor = count / PLIST_SIZE;
+
+        // A first look without locks, with a single read of the plist. A bucket with an elist holds a pair at least, since empty ones are unlinked
+        remote_plist red = is_local(p) ? p : pool_->ExtendedRead<PList>(p, factor);
+        if (!is_local(p)) stats.bytes_read += sizeof(PList) * factor;
+        size_t used = 0;
+        for (uint64_t i = 0; i < count && used <= limit; i++){
+            bucket_t b = is_local(p) ? read_bucket(p, i) : local_bucket(red, i);
+            if (is_permanent(b)) used = limit + 1;
+            else if (!is_null(base_of(b))) used++;
+            else if constexpr (BUCKET_PAIRS > 0) used += local_pairs(red, i).count;
+        }
+        if (!is_local(p)) pool_->Deallocate<PList>(red, factor);
+        if (used > limit) return false;
+
+        // Lock every bucket and take its pairs. The cohort only follows a single bucket per thread, so the locks are taken directly
+        struct held_t {
+            bucket_t b;
+            remote_elist base;
+            remote_elist e; // What read_locked gave
+            uint64_t closed;
+        };
+        std::vector<held_t> held;
+        held.reserve(count);
+        size_t total = 0;
+        bool foldable = true;
+        for (uint64_t i = 0; i < count && foldable; i++){
+            bucket_t b = read_bucket(p, i);
+            if (!acquire_remote(bucket_slot(p, i), b)){
+                foldable = false;
+                break;
+            }
+            remote_elist base = static_cast<remote_elist>(base_of(b));
+            uint64_t closed = close_elist(base);
+            remote_elist e = read_locked(p, i, base);
+            held.push_back({b, base, e, closed});
+            total += e->count;
+            foldable = total <= limit && e->overflow == 0;
+        }
+        remote_bucket pslot = lock_slot(parent, parent_bucket);
+        if (foldable){
+            // Not where we found it. Can't happen while p has a bucket locked, but there is no undoing a fold.
+            // Nor while a waiter from before the split still has a ticket of the parent's bucket out (see return_ticket)
+            bucket_t pb = read_word(pslot);
+            foldable = state_of(pb) == P_UNLOCKED && base_of(pb) == static_cast<remote_baseptr>(p) && serving_of(pb) == next_ticket_of(pb);
+        }
+        if (!foldable){
+            for (uint64_t i = 0; i < held.size(); i++) release_elist(p, i, held[i].b, held[i].base, held[i].e, false, held[i].closed);
+            return false;
+        }
+
+        // Gather the pairs, in the parent's bucket itself if they fit or in an elist built in our pool and moved to where it belongs
+        remote_elist folded = allocate_elist();
+        for (held_t &h : held){
+            for (size_t j = 0; j < h.e->count; j++) folded->elist_insert(h.e->pairs[j], h.e->tags[j]);
+        }
+        if (folded->count <= BUCKET_PAIRS){
+            if constexpr (BUCKET_PAIRS > 0){
+                InlinePairs pairs;
+                pairs.count = folded->count;
+                std::copy(folded->tags, folded->tags + folded->count, pairs.tags);
+                std::copy(folded->pairs, folded->pairs + folded->count, pairs.pairs);
+                write_pairs(parent, parent_bucket, remote_nullptr, pairs);
+            }
+            pool_->Deallocate<EList>(folded);
+            folded = remote_nullptr;
+        } else {
+            folded = settle_elist(folded);
+        }
+
+        // Tell lock-free readers with a stale pointer that the elists are gone
+        for (held_t &h : held){
+            if (is_null(h.base)) continue;
+            h.e->mark_moved();
+            if (!is_local(h.base)) write_elist(h.base, *h.e);
+        }
+
+        // No one else writes a permanently unlocked bucket, so the parent's is locked with a plain write. It stays locked while root's replicas
+        // are written, like any change to the root. A reader that still finds p meanwhile is held up by p's locks
+        write_word(pslot, take_ticket(make_bucket(static_cast<remote_baseptr>(folded), E_UNLOCKED)));
+        change_bucket_pointer(parent, parent_bucket, static_cast<remote_baseptr>(folded), E_UNLOCKED);
+
+        // The buckets of p send whoever still reaches them back to the root. Then p is only reachable through stale cache entries,
+        // which expire before it is freed
+        for (uint64_t i = 0; i < count; i++){
+            unlock_remote(bucket_slot(p, i), make_bucket(remote_nullptr, FOLDED));
+            if (is_null(held[i].base) || !is_local(held[i].base)) pool_->Deallocate<EList>(held[i].e);
+            if (!is_null(held[i].base)) retire(held[i].base);
+        }
+        if (cache_ != nullptr) cache_->erase(parent, parent_bucket);
+        retire(p, factor);
+        stats.plists_folded++;
+        return true;
+    }
+
+    /// @brief Free an object (an elist, a folded plist or a payload) once no operation can be reading it
+    /// @param count the number of T the object spans
+    template <typename T>
+    inline void retire(remote_ptr<T> ptr, size_t count = 1){
+        if (reclaimer_ == nullptr) return;
+        stats.retired++;
+        reclaimer_->retire(ptr, count);
+    }
+
+    /// @brief The first word of an elist, which latch-free inserts CAS
+    inline remote_ptr<uint64_t> meta_word(remote_elist e){
+        return remote_ptr<uint64_t>(e.id(), e.address() + offsetof(EList, checksum));
+    }
+
+    /// @brief Close the elist of a locked bucket to latch-free inserts, before reading it. Its count can't change after that,
+    /// and the inserts that reserved a slot but didn't commit give up and take the lock
+    /// @return the first word of the elist once closed, or 0 if inserts don't go latch-free
+    uint64_t close_elist(remote_elist bucket_base){
+        if (!config_.latch_free_inserts || is_null(bucket_base)) return 0;
+        remote_ptr<uint64_t> word = meta_word(bucket_base);
+        uint64_t m = read_word(word);
+        while (!EList::is_closed(m)){
+            uint64_t closed = EList::with_reserved(m, EList::reserved_of(m) | EList::CLOSED);
+            uint64_t v = cas_word(word, m, closed);
+            if (v == m) return closed;
+            m = v;
+        }
+        return m;
+    }
+
+    /// @brief The elist of a locked bucket to operate on: the elist itself if it is local, otherwise a copy of it.
+    /// A bucket without an elist gives a copy of its inline pairs (maybe none), which release_elist puts back
+    inline remote_elist read_locked(remote_plist curr, uint64_t bucket, remote_elist bucket_base){
+        if (is_null(bucket_base)) return load_inline(curr, bucket);
+        return is_local(bucket_base) ? bucket_base : read_elist(bucket_base);
+    }
+
+    /// @brief The inline pairs of a locked bucket, as an elist in our pool
+    remote_elist load_inline(remote_plist curr, uint64_t bucket){
+        remote_elist e = allocate_elist();
+        if constexpr (BUCKET_PAIRS > 0){
+            InlinePairs pairs = read_pairs(lock_slot(curr, bucket));
+            for (size_t i = 0; i < pairs.count; i++) e->elist_insert(pairs.pairs[i], pairs.tags[i]);
+        }
+        return e;
+    }
+
+    /// @brief Put back the pairs of a locked bucket without an elist, and unlock the bucket. They stay in the bucket if they fit,
+    /// otherwise they spill: e becomes the bucket's elist
+    /// @param e the pairs, from load_inline
+    void store_inline(remote_plist curr, uint64_t bucket, bucket_t b, remote_elist e, bool modified){
+        if (e->count > BUCKET_PAIRS){
+            e = settle_elist(e);
+            if constexpr (BUCKET_PAIRS > 0) write_pairs(curr, bucket, static_cast<remote_baseptr>(e), InlinePairs());
+            change_bucket_pointer(curr, bucket, static_cast<remote_baseptr>(e), E_UNLOCKED);
+            return;
+        }
+        if constexpr (BUCKET_PAIRS > 0){
+            if (modified){
+                InlinePairs pairs;
+                pairs.count = e->count;
+                std::copy(e->tags, e->tags + e->count, pairs.tags);
+                std::copy(e->pairs, e->pairs + e->count, pairs.pairs);
+                write_pairs(curr, bucket, remote_nullptr, pairs);
+            }
+        }
+        unlock(lock_slot(curr, bucket), b);
+        pool_->Deallocate<EList>(e);
+    }
+
+    /// @brief Write back the elist of a locked bucket and unlock the bucket. The elist is reopened to latch-free inserts if it was closed,
+    /// unless inserts were still in flight when it was. They might still write to their slots, so the elist is replaced by a copy instead
+    /// @param bucket_base the elist
+    /// @param e our copy of the elist (bucket_base itself if it is local), which is deallocated
+    /// @param modified if e has to be written back
+    /// @param closed what close_elist returned
+    /// @param touched the only slot of e that was changed, or ELIST_SIZE if it could be any (see write_elist)
+    void release_elist(remote_plist curr, uint64_t bucket, bucket_t b, remote_elist bucket_base, remote_elist e, bool modified, uint64_t closed, size_t touched = ELIST_SIZE){
+        if (is_null(bucket_base)){
+            store_inline(curr, bucket, b, e, modified);
+            return;
+        }
+        if (closed != 0 && EList::reserved_of(closed) != EList::count_of(closed)){
+            remote_elist fresh = allocate_elist();
+            *std::to_address(fresh) = *std::to_address(e);
+            fresh->reserved = fresh->count;
+            change_bucket_pointer(curr, bucket, static_cast<remote_baseptr>(fresh), E_UNLOCKED);
+            retire(bucket_base);
+        } else {
+            // If we are modifying a local copy, we need to write to the remote before unlocking
+            if (modified && !is_local(bucket_base)) write_elist(bucket_base, *e, touched);
+            // Reopened after the write lands, so no slot of it can overwrite a new reservation
+            if (closed != 0) write_word(meta_word(bucket_base), EList::with_reserved(e->meta(), e->count));
+            unlock(lock_slot(curr, bucket), b);
+        }
+        if (!is_local(bucket_base)) pool_->Deallocate<EList>(e);
+    }
+
+    /// @brief Write a pair and its tag into a reserved slot of an elist, past its count where no reader looks
+    inline void write_slot(remote_elist e, size_t i, const pair_t &pair, uint8_t tag){
+        if (is_local(e)){
+            e->tags[i] = tag;
+            e->pairs[i] = pair;
+            return;
+        }
+        stats.bytes_written += sizeof(pair_t) + sizeof(uint8_t);
+        pool_->Write<pair_t>(remote_ptr<pair_t>(e.id(), e.address() + offsetof(EList, pairs) + sizeof(pair_t) * i), pair);
+        pool_->Write<uint8_t>(remote_ptr<uint8_t>(e.id(), e.address() + offsetof(EList, tags) + i), tag);
+    }
+
+    /// @brief Free the payload of a pair that was never committed. No one but us saw it
+    inline void discard_pair(const pair_t &pair){
+        if constexpr (!EList::INLINE) pool_->Deallocate<uint64_t>(unpack_ptr<uint64_t>(pair.payload), payload_words(pair.key_len + pair.val_len));
+    }
+
+    /// @brief Insert into an elist without locking its bucket. A slot is reserved with a fetch-and-add on the elist's reserved count, the pair is written into it,
+    /// and once every slot before it is committed, a CAS bumps the count and the checksum together. Readers never see the pair before that.
+    /// A key that is already there fails the insert, whether it was there before we reserved or committed ahead of us
+    /// @param bucket_base the elist, not null
+    /// @return the result, or std::nullopt if the insert has to take the bucket's lock: the elist is full, rehashed or closed by a locked writer
+    std::optional<HT_Res<V>> insert_latch_free(remote_elist bucket_base, const K &key, uint64_t hash, const V &value){
+        EList e;
+        while (!snapshot_elist(bucket_base, e)); // retry until we get a copy that wasn't torn by a writer
+        if (e.is_moved()) return std::nullopt;
+        V result;
+        if (find_key(e, key, hash, result) < e.count) return HT_Res<V>(FALSE_STATE, result);
+
+        // Reserve a slot. The NIC's fetch-and-add isn't exposed by the pool, so it is a CAS loop starting from the word we read
+        remote_ptr<uint64_t> word = meta_word(bucket_base);
+        uint64_t m = e.meta();
+        while (true){
+            if (EList::is_closed(m) || EList::reserved_of(m) >= ELIST_SIZE){
+                // Full (the lock rehashes it) or a locked writer has it
+                stats.latch_free_fallbacks++;
+                return std::nullopt;
+            }
+            uint64_t v = cas_word(word, m, EList::with_reserved(m, EList::reserved_of(m) + 1));
+            if (v == m) break;
+            m = v;
+        }
+        size_t mine = EList::reserved_of(m);
+        pair_t pair = make_pair(key, hash, value);
+        uint8_t tag = tag_of(hash);
+        write_slot(bucket_base, mine, pair, tag);
+
+        // Commit in the order of the slots, so the count only ever covers written pairs
+        while (true){
+            m = read_word(word);
+            if (!EList::is_closed(m) && EList::count_of(m) < mine) continue; // The slots before ours aren't committed yet
+            if (!EList::is_closed(m)){
+                while (!snapshot_elist(bucket_base, e));
+                m = e.meta();
+            }
+            if (EList::is_closed(m)){
+                // A locked writer froze the count before we got to commit. Our slot is a hole it won't reopen, so take the lock
+                discard_pair(pair);
+                stats.latch_free_fallbacks++;
+                return std::nullopt;
+            }
+            if (e.count != mine) continue;
+            if (find_key(e, key, hash, result) < e.count){
+                // The key committed ahead of us. Give our slot back if it is the last one handed out, otherwise the slots after it
+                // would wait for ours forever: close the elist so they take the lock, and the next locked writer replaces it
+                uint64_t give_back = EList::reserved_of(m) == mine + 1 ? EList::with_reserved(m, mine) : EList::with_reserved(m, EList::reserved_of(m) | EList::CLOSED);
+                if (cas_word(word, m, give_back) != m) continue;
+                discard_pair(pair);
+                return HT_Res<V>(FALSE_STATE, result);
+            }
+            e.tags[mine] = tag;
+            e.pairs[mine] = pair;
+            e.count = mine + 1;
+            e.seal();
+            // Slots reserved after ours change the word without touching what we commit, so only those are retried without a re-read
+            while (true){
+                uint64_t v = cas_word(word, m, EList::with_reserved(e.meta(), m >> 48));
+                if (v == m){
+                    stats.latch_free_inserts++;
+                    return HT_Res<V>(TRUE_STATE, V());
+                }
+                if (EList::is_closed(v) || (v & 0xFFFFFFFFFFFFull) != (m & 0xFFFFFFFFFFFFull)) break;
+                m = v;
+            }
+        }
+    }
+    /// @brief Gets a value at the key by locking its bucket.
+    /// @param key the key to search on
+    /// @return if the key was found or not. The value at the key is stored in RdmaIHT::result
+    HT_Res<V> contains_locked(K key){
+        // start at the deepest plist we know of for this key (the root if nothing is cached)
+        uint64_t hash = hasher_.hash(key);
+        size_t depth = 1, count = root_count;
+        remote_plist curr = cached_start(hash, depth, count);
+        while (true) {
+            uint64_t bucket = level_hash(hash, depth, count);
+            remote_bucket slot = lock_slot(curr, bucket);
+            // Only the bucket we hashed to is read, never the whole plist
+            bucket_t b = read_bucket(curr, bucket);
+            if (combining() && !is_permanent(b)){
+                std::optional<HT_Res<V>> res = combine(CONTAINS, curr, bucket, depth, count, key, hash, V());
+                if (res.has_value()) return *res;
+                b = read_bucket(curr, bucket);
+            }
+            if (!acquire(slot, b)){
+                if (state_of(b) == FOLDED){
+                    curr = from_root(depth, count);
+                    continue;
+                }
+                // Can't lock then we are at a sub-plist
+                // The state and pointer are one word, so the pointer is the sub-plist the bucket held when we saw it. If compaction folds it
+                // after that, its buckets are FOLDED and send us back to the root, and the reclaimer keeps it alive until our operation is done
+                remote_plist bucket_base = static_cast<remote_plist>(base_of(b));
+                remember_plist(curr, bucket, bucket_base);
+                curr = bucket_base;
+                depth++;
+                count = child_count(count);
+                continue;
+            }
+
+            // We locked an elist, we can read the baseptr and progress
+            remote_elist bucket_base = static_cast<remote_elist>(base_of(b));
+            uint64_t closed = close_elist(bucket_base);
+            remote_elist e = read_locked(curr, bucket, bucket_base);
+            if (chained(*e, depth)) return apply_chained(CONTAINS, curr, bucket, b, bucket_base, e, closed, key, hash, V());
+
+            // Get elist and linear search
+            V result;
+            bool found = find_key(*e, key, hash, result) < e->count;
+            release_elist(curr, bucket, b, bucket_base, e, false, closed);
+            return HT_Res<V>(found ? TRUE_STATE : FALSE_STATE, found ? result : V());
+        }
+    }
+    
+    /// @brief Gets a value at the key without locking its bucket.
+    /// The bucket is read instead of CAS-ed, and the EList copy is validated with its checksum (re-read if torn).
+    /// @param key the key to search on
+    /// @return if the key was found or not
+    HT_Res<V> contains_optimistic(K key){
+        start:
+        // start at the deepest plist we know of for this key (the root if nothing is cached)
+        uint64_t hash = hasher_.hash(key);
+        size_t depth = 1, count = root_count;
+        remote_plist curr = cached_start(hash, depth, count);
+        while (true) {
+            uint64_t bucket = level_hash(hash, depth, count);
+            // Only the bucket we hashed to is read, never the whole plist (along with the pairs it holds itself)
+            InlinePairs pairs;
+            bucket_t b = read_bucket(curr, bucket, pairs);
+            if (state_of(b) == FOLDED){
+                curr = from_root(depth, count);
+                continue;
+            }
+            if (state_of(b) == P_UNLOCKED){
+                // We are at a sub-plist
+                // The state and pointer are one word, so the pointer is the sub-plist the bucket held at our read. A fold after the read
+                // leaves its buckets FOLDED, which restarts us from the root, and it is only freed once our epoch is over
+                remote_plist bucket_base = static_cast<remote_plist>(base_of(b));
+                remember_plist(curr, bucket, bucket_base);
+                curr = bucket_base;
+                depth++;
+                count = child_count(count);
+                continue;
+            }
+
+            // An elist bucket. Without a pointer, its pairs are the ones it holds itself
+            remote_elist bucket_base = static_cast<remote_elist>(base_of(b));
+            if (is_null(bucket_base)){
+                V result;
+                if (find_inline(pairs, key, hash, result)) return HT_Res<V>(TRUE_STATE, result);
+                return HT_Res<V>(FALSE_STATE, V());
+            }
+
+            EList e;
+            while (!snapshot_elist(bucket_base, e)); // retry until we get a copy that wasn't torn by a writer
+            // The bucket was rehashed after we read its state, start over to find the new plist
+            if (e.is_moved()) goto start;
+
+            // Linear search, then the rest of the bucket's chain if it has one
+            V result;
+            if (find_key(e, key, hash, result) < e.count || find_in_chain(e.overflow, key, hash, result)) return HT_Res<V>(TRUE_STATE, result);
+            return HT_Res<V>(FALSE_STATE, V());
+        }
+    }
+
+    /// @brief A key of a batch that is still descending
+    struct batch_key_t {
+        size_t idx; // Index of the key in the batch
+        uint64_t hash; // The hash of the key
+        remote_plist curr; // The plist the key has reached
+        size_t depth;
+        size_t count;
+    };
+
+    /// @brief Run a batch of operations, sharing the work of keys that go to the same bucket.
+    /// Each round groups the pending keys by the bucket they are at. A group reads (or locks) its bucket once, then either moves
+    /// all of its keys down to the sub-plist or applies all of its operations to a single copy of the EList.
+    /// @param op_type CONTAINS, INSERT or REMOVE
+    /// @param keys the keys to operate on
+    /// @param values the values to insert. Only used by INSERT
+    /// @return the result for each key, in the order of keys
+    std::vector<HT_Res<V>> run_batch(int op_type, std::span<const K> keys, std::span<const V> values){
+        EpochReclaimer::Guard guard(reclaimer_, reclaim_slot_);
+        serve_peers();
+        std::vector<HT_Res<V>> results(keys.size(), HT_Res<V>(FALSE_STATE, V()));
+        stats.ops += keys.size();
+        std::vector<batch_key_t> pending;
+        pending.reserve(keys.size());
+        // A repeated key starts where its first occurrence does, so they stay in the same group even if the cache changes in between
+        std::unordered_map<K, size_t> first;
+        for (size_t i = 0; i < keys.size(); i++){
+            batch_key_t k = {i, hasher_.hash(keys[i]), remote_nullptr, 1, root_count};
+            auto [it, fresh] = first.try_emplace(keys[i], i);
+            if (fresh){
+                k.curr = cached_start(k.hash, k.depth, k.count);
+            } else {
+                k.curr = pending[it->second].curr;
+                k.depth = pending[it->second].depth;
+                k.count = pending[it->second].count;
+            }
+            pending.push_back(k);
+        }
+        while (!pending.empty()){
+            // Group by (plist, bucket). The keys of a group keep their order in the batch, so repeated keys apply in order
+            std::map<std::pair<uint64_t, uint64_t>, std::vector<batch_key_t>> groups;
+            for (batch_key_t &k : pending){
+                uint64_t bucket = level_hash(k.hash, k.depth, k.count);
+                groups[{pack_ptr(k.curr), bucket}].push_back(k);
+            }
+            pending.clear();
+            for (auto &[where, group] : groups){
+                if (op_type == CONTAINS && config_.optimistic_reads) batch_group_optimistic(where.second, group, keys, results, pending);
+                else batch_group_locked(op_type, where.second, group, keys, values, results, pending);
+            }
+        }
+        return results;
+    }
+
+    /// @brief A key of a batch that reached a folded plist, back at the root. The keys of its group go back together, so repeated keys stay in order
+    inline batch_key_t restart_key(const batch_key_t &k){
+        batch_key_t r = k;
+        r.curr = from_root(r.depth, r.count);
+        return r;
+    }
+
+    /// @brief Look up a group of keys that are at the same bucket without locking it
+    /// @param bucket the bucket the group is at
+    /// @param group the keys at the bucket
+    /// @param pending where to put the keys that need another round
+    void batch_group_optimistic(uint64_t bucket, std::vector<batch_key_t> &group, std::span<const K> keys, std::vector<HT_Res<V>> &results, std::vector<batch_key_t> &pending){
+        remote_plist curr = group[0].curr;
+        InlinePairs pairs;
+        bucket_t b = read_bucket(curr, bucket, pairs);
+        if (state_of(b) == FOLDED){
+            for (batch_key_t &k : group) pending.push_back(restart_key(k));
+            return;
+        }
+        if (state_of(b) == P_UNLOCKED){
+            // A sub-plist, move the whole group down
+            remote_plist bucket_base = static_cast<remote_plist>(base_of(b));
+            remember_plist(curr, bucket, bucket_base);
+            for (batch_key_t &k : group) pending.push_back({k.idx, k.hash, bucket_base, k.depth + 1, child_count(k.count)});
+            return;
+        }
+
+        // An elist bucket. Without a pointer, its pairs are the ones it holds itself (the results are already false)
+        remote_elist bucket_base = static_cast<remote_elist>(base_of(b));
+        if (is_null(bucket_base)){
+            for (batch_key_t &k : group){
+                V result;
+                if (find_inline(pairs, keys[k.idx], k.hash, result)) results[k.idx] = HT_Res<V>(TRUE_STATE, result);
+            }
+            return;
+        }
+        EList e;
+        while (!snapshot_elist(bucket_base, e)); // retry until we get a copy that wasn't torn by a writer
+        if (e.is_moved()){
+            // The bucket was rehashed after we read it, it is a sub-plist next round
+            for (batch_key_t &k : group) pending.push_back(k);
+            return;
+        }
+        for (batch_key_t &k : group){
+            V result;
+            if (find_key(e, keys[k.idx], k.hash, result) < e.count || find_in_chain(e.overflow, keys[k.idx], k.hash, result)) results[k.idx] = HT_Res<V>(TRUE_STATE, result);
+        }
+    }
+
+    /// @brief Apply the operations of a group of keys that are at the same bucket, under a single lock of it
+    /// @param op_type CONTAINS, INSERT or REMOVE
+    /// @param bucket the bucket the group is at
+    /// @param group the keys at the bucket
+    /// @param pending where to put the keys that need another round
+    void batch_group_locked(int op_type, uint64_t bucket, std::vector<batch_key_t> &group, std::span<const K> keys, std::span<const V> values, std::vector<HT_Res<V>> &results, std::vector<batch_key_t> &pending){
+        remote_plist curr = group[0].curr;
+        size_t depth = group[0].depth, count = group[0].count;
+        std::vector<group_op_t> ops;
+        ops.reserve(group.size());
+        for (batch_key_t &k : group) ops.push_back({op_type, &keys[k.idx], k.hash, op_type == INSERT ? &values[k.idx] : nullptr, &results[k.idx]});
+        remote_plist sub;
+        size_t done = apply_group(curr, bucket, depth, count, ops, sub);
+        // The rest go again next round. At the sub-plist if the bucket is one, at the root if its plist was folded, otherwise at the bucket (which rehashes the elist)
+        for (size_t j = done; j < group.size(); j++){
+            if (is_null(sub)) pending.push_back(group[j]);
+            else if (sub == local_root) pending.push_back(restart_key(group[j]));
+            else pending.push_back({group[j].idx, group[j].hash, sub, depth + 1, child_count(count)});
+        }
+    }
+
+    /// @brief An operation of a group that is applied under a single lock of its bucket
+    struct group_op_t {
+        int op_type; // CONTAINS, INSERT or REMOVE
+        const K* key;
+        uint64_t hash; // The hash of key
+        const V* value; // The value to insert. Only used by INSERT
+        HT_Res<V>* result; // Where to put the result
+    };
+
+    /// @brief Apply a group of operations that are at the same bucket, in order, under a single lock of it and to a single copy of its elist
+    /// @param curr the plist holding the bucket
+    /// @param bucket the bucket the group is at
+    /// @param depth the depth of curr
+    /// @param count the number of buckets in curr
+    /// @param ops the operations
+    /// @param sub set to the sub-plist if the bucket is (or was made into) one, to local_root if curr was folded (the group starts over), otherwise remote_nullptr
+    /// @return the number of operations applied. The ones after that didn't get a result, and have to go again
+    size_t apply_group(remote_plist curr, uint64_t bucket, size_t depth, size_t count, std::span<group_op_t> ops, remote_plist &sub){
+        sub = remote_nullptr;
+        remote_bucket slot = lock_slot(curr, bucket);
+        bucket_t b = read_bucket(curr, bucket);
+        if (!acquire(slot, b)){
+            if (state_of(b) == FOLDED){
+                sub = local_root;
+                return 0;
+            }
+            // Can't lock then we are at a sub-plist, the whole group moves down
+            sub = static_cast<remote_plist>(base_of(b));
+            remember_plist(curr, bucket, sub);
+            return 0;
+        }
+
+        // We locked an elist, apply every operation of the group to one copy of it
+        remote_elist bucket_base = static_cast<remote_elist>(base_of(b));
+        uint64_t closed = close_elist(bucket_base);
+        remote_elist e = read_locked(curr, bucket, bucket_base);
+        if (chained(*e, depth)){
+            apply_chained(curr, bucket, b, bucket_base, e, closed, ops);
+            return ops.size();
+        }
+        bool modified = false;
+        size_t done = 0;
+        for (; done < ops.size(); done++){
+            group_op_t &op = ops[done];
+            V result;
+            size_t i = find_key(*e, *op.key, op.hash, result);
+            bool found = i < e->count;
+            if (op.op_type == CONTAINS){
+                *op.result = HT_Res<V>(found ? TRUE_STATE : FALSE_STATE, found ? result : V());
+            } else if (op.op_type == REMOVE){
+                *op.result = HT_Res<V>(found ? TRUE_STATE : FALSE_STATE, found ? result : V());
+                if (found){
+                    remove_pair(e, i);
+                    modified = true;
+                }
+            } else if (found){
+                // Contains the key => insert fails
+                *op.result = HT_Res<V>(FALSE_STATE, result);
+            } else if (e->count < ELIST_SIZE){
+                insert_pair(e, *op.key, op.hash, *op.value);
+                *op.result = HT_Res<V>(TRUE_STATE, V());
+                modified = true;
+            } else {
+                break; // no room left
+            }
+        }
+
+        if (done < ops.size() && !modified){
+            // The elist was already full. Rehash into plist and perma-unlock, and the rest of the group moves down
+            sub = split_bucket(curr, bucket, bucket_base, e, count, depth);
+            if (!is_local(bucket_base)) pool_->Deallocate<EList>(e);
+            return done;
+        }
+
+        if (modified && can_unlink(bucket_base, e)){
+            // We removed everything, so get rid of the elist
+            unlink_elist(curr, bucket, bucket_base);
+            if (!is_local(bucket_base)) pool_->Deallocate<EList>(e);
+        } else {
+            release_elist(curr, bucket, b, bucket_base, e, modified, closed);
+        }
+        return done;
+    }
+
+    /// @brief If the elist of a locked bucket is part of a chain, or has to start one to take another pair.
+    /// Only the buckets of a plist at the max depth chain, and their operations go through apply_chained
+    inline bool chained(const EList &e, size_t depth){
+        return e.overflow != 0 || (at_max_depth(depth) && e.count == ELIST_SIZE);
+    }
+
+    /// @brief An elist of a chain, as apply_chained works on it
+    struct link_t {
+        remote_elist at; // Where it is. remote_nullptr for one we are adding
+        remote_elist e; // Our copy of it, or the elist itself if it is local
+        bool modified;
+    };
+
+    /// @brief Apply a group of operations to a locked bucket whose elists are chained, in order, and unlock it. A key can be in any elist of the chain.
+    /// An insert goes to the first elist with room, or to a new elist at the head of the chain if there is none. The elists of a chain are never split
+    /// @param e our copy of the bucket's elist (the head of the chain), from read_locked
+    /// @param closed the head's first word, from close_elist
+    void apply_chained(remote_plist curr, uint64_t bucket, bucket_t b, remote_elist bucket_base, remote_elist e, uint64_t closed, std::span<group_op_t> ops){
+        std::vector<link_t> links = {{bucket_base, e, false}};
+        for (uint64_t next = e->overflow; next != 0; next = links.back().e->overflow){
+            remote_elist at = unpack_ptr<EList>(next);
+            links.push_back({at, is_local(at) ? at : read_elist(at), false});
+        }
+        for (group_op_t &op : ops){
+            V result;
+            size_t l = 0, i = 0;
+            for (; l < links.size(); l++){
+                i = find_key(*links[l].e, *op.key, op.hash, result);
+                if (i < links[l].e->count) break;
+            }
+            bool found = l < links.size();
+            if (op.op_type != INSERT || found){
+                // Contains the key => insert fails
+                *op.result = HT_Res<V>(found && op.op_type != INSERT ? TRUE_STATE : FALSE_STATE, found ? result : V());
+                if (found && op.op_type == REMOVE){
+                    remove_pair(links[l].e, i);
+                    links[l].modified = true;
+                }
+                continue;
+            }
+            for (l = 0; l < links.size() && links[l].e->count == ELIST_SIZE; l++);
+            if (l == links.size()) links.push_back({remote_nullptr, allocate_elist(), true});
+            insert_pair(links[l].e, *op.key, op.hash, *op.value);
+            links[l].modified = true;
+            *op.result = HT_Res<V>(TRUE_STATE, V());
+        }
+
+        // The new elists go in front of the head, which is part of the chain from then on
+        remote_elist head = bucket_base;
+        for (size_t l = 1; l < links.size(); l++){
+            if (!is_null(links[l].at)){
+                if (links[l].modified && !is_local(links[l].at)) write_elist(links[l].at, *links[l].e);
+                if (!is_local(links[l].at)) pool_->Deallocate<EList>(links[l].e);
+                continue;
+            }
+            remote_elist fresh = links[l].e;
+            fresh->overflow = pack_ptr(head);
+            fresh->reserved |= EList::CLOSED;
+            fresh->seal();
+            head = settle_elist(fresh);
+            stats.chained_elists++;
+        }
+        if (head == bucket_base){
+            // Latch-free inserts would miss the keys in the rest of the chain, so the head of one stays closed
+            release_elist(curr, bucket, b, bucket_base, e, links[0].modified, e->overflow == 0 ? closed : 0);
+            return;
+        }
+        if (links[0].modified && !is_local(bucket_base)) write_elist(bucket_base, *e);
+        change_bucket_pointer(curr, bucket, static_cast<remote_baseptr>(head), E_UNLOCKED);
+        if (!is_local(bucket_base)) pool_->Deallocate<EList>(e);
+    }
+
+    /// @brief apply_chained for a single operation
+    HT_Res<V> apply_chained(int op_type, remote_plist curr, uint64_t bucket, bucket_t b, remote_elist bucket_base, remote_elist e, uint64_t closed, const K &key, uint64_t hash, const V &value){
+        HT_Res<V> res = HT_Res<V>(FALSE_STATE, V());
+        group_op_t op = {op_type, &key, hash, &value, &res};
+        apply_chained(curr, bucket, b, bucket_base, e, closed, std::span<group_op_t>(&op, 1));
+        return res;
+    }
+
+    /// @brief Search the rest of a bucket's chain for a key without locking the bucket. The elists of a chain are never unlinked, so any of them can be read
+    /// @param next the overflow pointer of the elist the search is past
+    /// @return if the key was found, in which case val is updated to its value
+    bool find_in_chain(uint64_t next, const K &key, uint64_t hash, V &val){
+        EList e;
+        for (; next != 0; next = e.overflow){
+            while (!snapshot_elist(unpack_ptr<EList>(next), e)); // retry until we get a copy that wasn't torn by a writer
+            if (find_key(e, key, hash, val) < e.count) return true;
+        }
+        return false;
+    }
+
+    /// @brief If synchronous operations at an elist bucket go through the node's combiner
+    inline bool combining(){
+        return combiner_ != nullptr && combiner_->enabled();
+    }
+
+    /// @brief Hand an operation at an elist bucket to the node's combiner, which applies it along with the node's other operations at the bucket
+    /// @param curr the plist holding the bucket
+    /// @param bucket the bucket the operation is at
+    /// @param depth the depth of curr
+    /// @param count the number of buckets in curr
+    /// @return the result, or std::nullopt if the operation has to go on by itself (the bucket is a sub-plist now, or its elist is full)
+    std::optional<HT_Res<V>> combine(int op_type, remote_plist curr, uint64_t bucket, size_t depth, size_t count, const K &key, uint64_t hash, const V &value){
+        typedef typename Combiner<K, V>::request_t request_t;
+        request_t req = {pack_ptr(lock_slot(curr, bucket)), op_type, key, hash, value};
+        std::vector<request_t*> batch;
+        if (combiner_->publish(req, batch)){
+            // Our turn to combine
+            std::vector<group_op_t> ops;
+            ops.reserve(batch.size());
+            for (request_t* r : batch) ops.push_back({r->op_type, &r->key, r->hash, &r->value, &r->result});
+            remote_plist sub;
+            size_t done = apply_group(curr, bucket, depth, count, ops, sub);
+            stats.combined_batches++;
+            stats.combined_ops += batch.size();
+            combiner_->finish(req.slot, batch, done);
+        }
+        if (req.state == Combiner<K, V>::RETRY) return std::nullopt;
+        return req.result;
+    }
+
+public:
+    typedef Combiner<K, V> NodeCombiner; // The combiner an IHT of these types shares with the other threads of its node
+
+    MemoryPool* pool_;
+    IHT_Stats stats; // Counters for this instance, reported with the results
+
+    using conn_type = MemoryPool::conn_type;
+
+    RdmaIHT(MemoryPool::Peer self, MemoryPool* pool, IHT_Config config = IHT_Config(), PListCache* cache = nullptr, EpochReclaimer* reclaimer = nullptr, LockCohort* cohort = nullptr, NodeCombiner* combiner = nullptr) : self_(self), config_(config), cache_(cache), reclaimer_(reclaimer), cohort_(cohort), combiner_(combiner), pool_(pool){
+        if ((PLIST_SIZE * sizeof(bucket_t) * SLOT_WORDS) % 64 != 0) ROME_INFO("Warning: Suboptimal PLIST_SIZE b/c PList needs to be aligned to 64 bytes");
+        if (((ELIST_SIZE * 8) + 4) % 64 < 60) ROME_INFO("Warning: Suboptimal ELIST_SIZE b/c EList needs to be aligned to 64 bytes");
+        // A sub-plist with its parent's count would split a full elist's keys into the same bucket again, level after level
+        ROME_ASSERT(config_.growth == Growth::DOUBLING || Hash::REMIXES_LEVELS, "Constant and capped growth need a hash policy that remixes each level, like MixedLevelHash");
+        if (reclaimer_ != nullptr) reclaim_slot_ = reclaimer_->register_thread();
+    };
+
+    ~RdmaIHT(){
+        if (reclaimer_ != nullptr) reclaimer_->unregister_thread(reclaim_slot_);
+    }
+
+    /// @brief Create a fresh iht
+    /// @param expected_keys how many keys the table is expected to hold, to size the root for. 0 gives the smallest root, of PLIST_SIZE buckets
+    /// @param presplit if every root bucket starts with an empty sub-plist, so the root is sized for two levels instead of one
+    /// @return the iht header pointer
+    remote_ptr<anon_ptr> InitAsFirst(size_t expected_keys = 0, bool presplit = false){
+        presplit = presplit && !at_max_depth(1);
+        root_count = root_size_for(expected_keys, presplit);
+        remote_plist iht_root = pool_->Allocate<PList>(root_count / PLIST_SIZE);
+        InitPList(iht_root, root_count / PLIST_SIZE);
+        if (presplit){
+            size_t sub_count = child_count(root_count);
+            for (uint64_t i = 0; i < root_count; i++){
+                remote_plist p = pool_->Allocate<PList>(sub_count / PLIST_SIZE);
+                InitPList(p, sub_count / PLIST_SIZE);
+                local_bucket(iht_root, i) = make_bucket(static_cast<remote_baseptr>(p), P_UNLOCKED);
+            }
+        }
+        ROME_INFO("Root has {} buckets{}", root_count, presplit ? ", each with a sub-plist" : "");
+        remote_header iht_header = pool_->Allocate<Header>();
+        iht_header->root = iht_root;
+        iht_header->root_count = root_count;
+        for (int i = 0; i < MAX_REPLICAS; i++){
+            iht_header->replicas[i] = 0;
+            iht_header->split_inboxes[i] = 0;
+            iht_header->stocks[i] = 0;
+        }
+        iht_header->replicas_version = 0;
+        iht_header->reclaim = EpochReclaimer::create_table(pool_);
+        // The host reads root directly. It is its own replica
+        if (config_.replicate_root && self_.id < MAX_REPLICAS) iht_header->replicas[self_.id] = pack_ptr(iht_root);
+        this->header = iht_header;
+        this->root = iht_root;
+        this->local_root = iht_root;
+        if (reclaimer_ != nullptr) reclaimer_->attach(iht_header->reclaim);
+        if (config_.offload_splits) register_split_inbox();
+        if (config_.placement != Placement::LOCAL) register_stock();
+        return static_cast<remote_ptr<anon_ptr>>(iht_header);
+    }
+
+    /// @brief Initialize an IHT from the pointer of another IHT
+    /// @param header_ptr the header pointer of the other iht from InitAsFirst();
+    void InitFromPointer(remote_ptr<anon_ptr> header_ptr){
+        this->header = static_cast<remote_header>(header_ptr);
+        remote_header h = is_local(header) ? header : pool_->Read<Header>(header);
+        this->root = h->root;
+        this->root_count = h->root_count;
+        if (reclaimer_ != nullptr) reclaimer_->attach(h->reclaim);
+        if (!is_local(header)) pool_->Deallocate<Header>(h);
+        this->local_root = root;
+        if (config_.replicate_root && !is_local(root)) register_replica();
+        if (config_.offload_splits) register_split_inbox();
+        if (config_.placement != Placement::LOCAL) register_stock();
+    }
+
+    /// @brief Gets a value at the key.
+    /// @param key the key to search on
+    /// @return if the key was found or not. The value at the key is stored in RdmaIHT::result
+    HT_Res<V> contains(K key){
+        stats.ops++;
+        EpochReclaimer::Guard guard(reclaimer_, reclaim_slot_);
+        serve_peers();
+        if (config_.optimistic_reads) return contains_optimistic(key);
+        return contains_locked(key);
+    }
+
+    /// @brief Insert a key and value into the iht. Result will become the value at the key if already present.
+    /// @param key the key to insert
+    /// @param value the value to associate with the key
+    /// @return if the insert was successful
+    HT_Res<V> insert(K key, V value){
+        stats.ops++;
+        EpochReclaimer::Guard guard(reclaimer_, reclaim_slot_);
+        serve_peers();
+        // start at the deepest plist we know of for this key (the root if nothing is cached)
+        uint64_t hash = hasher_.hash(key);
+        size_t depth = 1, count = root_count;
+        remote_plist curr = cached_start(hash, depth, count);
+        while (true){
+            uint64_t bucket = level_hash(hash, depth, count);
+            remote_bucket slot = lock_slot(curr, bucket);
+            // Only the bucket we hashed to is read, never the whole plist
+            bucket_t b = read_bucket(curr, bucket);
+            if (config_.latch_free_inserts && !is_permanent(b) && !is_null(base_of(b))){
+                std::optional<HT_Res<V>> res = insert_latch_free(static_cast<remote_elist>(base_of(b)), key, hash, value);
+                if (res.has_value()) return *res;
+                b = read_bucket(curr, bucket);
+            }
+            if (combining() && !is_permanent(b)){
+                std::optional<HT_Res<V>> res = combine(INSERT, curr, bucket, depth, count, key, hash, value);
+                if (res.has_value()) return *res;
+                b = read_bucket(curr, bucket);
+            }
+            if (!acquire(slot, b)){
+                if (state_of(b) == FOLDED){
+                    curr = from_root(depth, count);
+                    continue;
+                }
+                // Can't lock then we are at a sub-plist, the one named by the same word as the state. As in contains_locked,
+                // descending is safe even if it is folded meanwhile: we would find it FOLDED, and it isn't freed before we are done
+                remote_plist bucket_base = static_cast<remote_plist>(base_of(b));
+                remember_plist(curr, bucket, bucket_base);
+                curr = bucket_base;
+                depth++;
+                count = child_count(count);
+                continue;
+            }
+
+            // We locked an elist, we can read the baseptr and progress
+            remote_elist bucket_base = static_cast<remote_elist>(base_of(b));
+            uint64_t closed = close_elist(bucket_base);
+            remote_elist e = read_locked(curr, bucket, bucket_base);
+            if (chained(*e, depth)) return apply_chained(INSERT, curr, bucket, b, bucket_base, e, closed, key, hash, value);
+
+            // Linear search to determine if elist already contains the key
+            V result;
+            if (find_key(*e, key, hash, result) < e->count){
+                // Contains the key => unlock and return false
+                release_elist(curr, bucket, b, bucket_base, e, false, closed);
+                return HT_Res<V>(FALSE_STATE, result);
+            }
+
+            // Check for enough insertion room
+            if (e->count < ELIST_SIZE) {
+                // insert, write back (if we modified a local copy), unlock and return true
+                insert_pair(e, key, hash, value);
+                release_elist(curr, bucket, b, bucket_base, e, true, closed, e->count - 1);
+                return HT_Res<V>(TRUE_STATE, V());
+            }
+
+            // Need more room so rehash into plist and perma-unlock
+            remote_plist p = split_bucket(curr, bucket, bucket_base, e, count, depth);
+            if (!is_local(bucket_base)) pool_->Deallocate<EList>(e);
+            // continue in the plist we just made, we already know where it is
+            curr = p;
+            depth++;
+            count = child_count(count);
+        }
+    }
+    
+    /// @brief Will remove a value at the key. Will stored the previous value in result.
+    /// @param key the key to remove at
+    /// @return if the remove was successful
+    HT_Res<V> remove(K key){
+        stats.ops++;
+        EpochReclaimer::Guard guard(reclaimer_, reclaim_slot_);
+        serve_peers();
+        // start at the deepest plist we know of for this key (the root if nothing is cached)
+        uint64_t hash = hasher_.hash(key);
+        size_t depth = 1, count = root_count;
+        // Where curr hangs from, for compaction
+        remote_plist parent;
+        uint64_t parent_bucket = 0;
+        remote_plist curr = cached_start(hash, depth, count, &parent, &parent_bucket);
+        while (true) {
+            uint64_t bucket = level_hash(hash, depth, count);
+            remote_bucket slot = lock_slot(curr, bucket);
+            // Only the bucket we hashed to is read, never the whole plist
+            bucket_t b = read_bucket(curr, bucket);
+            if (combining() && !is_permanent(b)){
+                std::optional<HT_Res<V>> res = combine(REMOVE, curr, bucket, depth, count, key, hash, V());
+                if (res.has_value()){
+                    // The combiner doesn't tell if the bucket was emptied, but an emptied bucket has no elist
+                    if (res->status == TRUE_STATE && compacting() && !is_null(parent) && is_null(base_of(read_bucket(curr, bucket)))) fold_plist(parent, parent_bucket, curr, count);
+                    return *res;
+                }
+                b = read_bucket(curr, bucket);
+            }
+            if (!acquire(slot, b)){
+                if (state_of(b) == FOLDED){
+                    curr = from_root(depth, count);
+                    parent = remote_nullptr;
+                    continue;
+                }
+                // Can't lock then we are at a sub-plist, named by the word that told us so. It might get folded, which contains_locked
+                // covers: we restart at a FOLDED bucket, and it is reclaimed only after our operation
+                remote_plist bucket_base = static_cast<remote_plist>(base_of(b));
+                remember_plist(curr, bucket, bucket_base);
+                parent = curr;
+                parent_bucket = bucket;
+                curr = bucket_base;
+                depth++;
+                count = child_count(count);
+                continue;
+            }
+
+            // We locked an elist, we can read the baseptr and progress
+            remote_elist bucket_base = static_cast<remote_elist>(base_of(b));
+            uint64_t closed = close_elist(bucket_base);
+            remote_elist e = read_locked(curr, bucket, bucket_base);
+            if (chained(*e, depth)) return apply_chained(REMOVE, curr, bucket, b, bucket_base, e, closed, key, hash, V());
+
+            // Get elist and linear search to determine if elist already contains the value
+            V result; // saving the previous value at key
+            size_t i = find_key(*e, key, hash, result);
+            if (i < e->count){
+                remove_pair(e, i);
+                // A bucket we emptied might have left its plist sparse enough to fold
+                bool fold = e->count == 0 && compacting() && !is_null(parent);
+                if (can_unlink(bucket_base, e)){
+                    // We removed the last pair, so get rid of the elist
+                    unlink_elist(curr, bucket, bucket_base);
+                    if (!is_local(bucket_base)) pool_->Deallocate<EList>(e);
+                } else {
+                    // Write back (if we modified a local copy), unlock and return
+                    release_elist(curr, bucket, b, bucket_base, e, true, closed, i);
+                }
+                if (fold) fold_plist(parent, parent_bucket, curr, count);
+                return HT_Res<V>(TRUE_STATE, result);
+            }
+
+            // Can't find, unlock and return false
+            release_elist(curr, bucket, b, bucket_base, e, false, closed);
+            return HT_Res<V>(FALSE_STATE, V());
+        }
+    }
+
+    /// @brief Gets the values at a batch of keys. Keys that hash to the same bucket share its reads
+    /// @param keys the keys to search on
+    /// @return if each key was found or not, with its value, in the order of keys
+    std::vector<HT_Res<V>> contains_batch(std::span<const K> keys){
+        return run_batch(CONTAINS, keys, {});
+    }
+
+    /// @brief Insert a batch of keys and values. Keys that hash to the same bucket are inserted under a single lock and write of it
+    /// @param keys the keys to insert
+    /// @param values the value to associate with each key
+    /// @return if each insert was successful, in the order of keys. Like insert, a failed insert holds the value already at the key
+    std::vector<HT_Res<V>> insert_batch(std::span<const K> keys, std::span<const V> values){
+        ROME_ASSERT(keys.size() == values.size(), "insert_batch needs a value for every key");
+        return run_batch(INSERT, keys, values);
+    }
+
+    /// @brief Remove a batch of keys. Keys that hash to the same bucket are removed under a single lock and write of it
+    /// @param keys the keys to remove
+    /// @return if each remove was successful, with the previous value, in the order of keys
+    std::vector<HT_Res<V>> remove_batch(std::span<const K> keys){
+        return run_batch(REMOVE, keys, {});
+    }
+
+    /// Function signature added to match map interface. No intermediary cleanup necessary so unusued
+    void try_rehash(){
+        // Unused function b/c no cleanup necessary
+    }
+
+    /// @brief Populate only works when we have numerical keys. Will add data
+    /// @param count the number of values to insert. Recommended in total to do key_range / 2
+    /// @param key_lb the lower bound for the key range
+    /// @param key_ub the upper bound for the key range
+    /// @param value the value to associate with each key. Currently, we have asserts for result to be equal to the key. Best to set value equal to key!
+    void populate(int op_count, K key_lb, K key_ub, std::function<K(V)> value) requires std::is_arithmetic_v<K> {
+        // Populate only works when we have numerical keys
+        K key_range = key_ub - key_lb;
+
+        // Create a random operation generator that is 
+        // - evenly distributed among the key range
+        std::uniform_real_distribution<double> dist = std::uniform_real_distribution<double>(0.0, 1.0);
+        std::default_random_engine gen((unsigned) std::time(NULL));
+        for (int c = 0; c < op_count; c++){
+            int k = dist(gen) * key_range + key_lb;
+            insert(k, value(k));
+        }
+    }
+
+    /// @brief Load many pairs at once. The pairs are partitioned by root bucket between the callers: every thread of every node passes the same source
+    /// (or only the pairs of its part, see load_part_of) with its own part, and loads the root buckets b with b % parts == part. The subtree of each root bucket is built in our pool and published with a single write.
+    /// A root bucket that is permanently unlocked (as all of them are with a presplit root) is loaded the same way one level down, into each bucket of its sub-plist.
+    /// A bucket that already holds pairs is loaded with insert_batch instead. A key that is repeated keeps its first value, like insert.
+    /// @param keys the keys to load
+    /// @param values the value of each key
+    /// @param part which part of the root buckets to load
+    /// @param parts the number of callers loading the source
+    /// @return the number of pairs that were loaded
+    size_t bulk_load(std::span<const K> keys, std::span<const V> values, size_t part, size_t parts){
+        ROME_ASSERT(keys.size() == values.size(), "bulk_load needs a value for every key");
+        ROME_ASSERT(part < parts, "bulk_load part {} is not one of {} parts", part, parts);
+        EpochReclaimer::Guard guard(reclaimer_, reclaim_slot_);
+        std::vector<std::vector<load_t>> buckets(root_count);
+        std::unordered_set<K> seen;
+        for (size_t i = 0; i < keys.size(); i++){
+            uint64_t hash = hasher_.hash(keys[i]);
+            uint64_t bucket = level_hash(hash, 1, root_count);
+            if (bucket % parts != part || !seen.insert(keys[i]).second) continue;
+            buckets[bucket].push_back({i, hash});
+        }
+
+        size_t loaded = 0;
+        for (uint64_t bucket = 0; bucket < root_count; bucket++){
+            if (!buckets[bucket].empty()) loaded += load_bucket(local_root, bucket, buckets[bucket], keys, values, root_count, 1);
+        }
+        stats.bulk_loaded += loaded;
+        return loaded;
+    }
+
+    /// @brief The part of a bulk load a key belongs to. A caller can pass bulk_load only the keys of its part, instead of the whole source
+    size_t load_part_of(const K &key, size_t parts){
+        return level_hash(hasher_.hash(key), 1, root_count) % parts;
+    }
+
+    /// @brief Load the pairs of a binary file, a sequence of (key, value) records. Only the records of our part are kept in memory.
+    /// @param path the file to load
+    /// @param part which part of the root buckets to load
+    /// @param parts the number of callers loading the file
+    /// @return the number of pairs that were loaded
+    size_t bulk_load_file(const std::string &path, size_t part, size_t parts) requires (std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>) {
+        struct record_t {
+            K key;
+            V value;
+        };
+        std::ifstream file(path, std::ios::binary);
+        ROME_ASSERT(file.is_open(), "Couldn't open {} to bulk load", path);
+        std::vector<K> keys;
+        std::vector<V> values;
+        std::vector<record_t> chunk(4096);
+        while (file){
+            file.read(reinterpret_cast<char*>(chunk.data()), sizeof(record_t) * chunk.size());
+            size_t red = file.gcount() / sizeof(record_t);
+            for (size_t i = 0; i < red; i++){
+                if (load_part_of(chunk[i].key, parts) != part) continue;
+                keys.push_back(chunk[i].key);
+                values.push_back(chunk[i].value);
+            }
         }
+        return bulk_load(keys, values, part, parts);
     }
 };
@@ -91,13 +91,7 @@ public:
 
     /// Freeze a LinkedSet and prevent changes to it
     void freeze(MemoryPool* pool){
-         // Spin while trying to acquire the lock
-        while (true){
-            lock_type v = pool->CompareAndSwap<lock_type>(lock, UNLOCKED, LOCKED);
-
-            // If we can switch from unlock to lock status
-            if (v == UNLOCKED) return;
-        }
+        acquire(pool, lock);
     }
 
     /// Notify clients that the linked lists are detached completely
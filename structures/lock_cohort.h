@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "common.h"
+#include "lock_strategy.h"
+
+/// @brief Node-local cohorts of remote locks, shared by all the threads of a node.
+/// A thread takes the local lock of a remote lock's cohort before the remote lock itself, so only one thread per node (the cohort's leader) talks to the remote lock.
+/// When the leader is done while other local threads wait, it passes the remote lock on without releasing it, up to CNF_COHORT_PASSES times in a row.
+/// Remote locks are mapped to cohorts by address, into a fixed number of stripes. Remote locks that share a stripe share a cohort,
+/// so a thread can be passed a remote lock it didn't ask for. It has to release that lock before taking its own.
+class LockCohort {
+public:
+    /// @brief A remote lock the cohort kept held for its next member
+    struct held_t {
+        uint64_t addr = 0; // The packed pointer to the remote lock. 0 if the cohort holds nothing
+        uint64_t value = 0; // What the remote lock should be after unlocking, as its last holder left it
+    };
+
+private:
+    struct alignas(64) stripe_t {
+        std::mutex lock;
+        std::atomic<int> waiting{0}; // Threads waiting for lock
+        held_t held;
+        int passes = 0; // Times held was passed on in a row
+    };
+
+    size_t mask_;
+    std::unique_ptr<stripe_t[]> stripes_;
+
+    // splitmix64 finalizer, to spread the lock addresses (which are 8 byte aligned) across the stripes
+    inline stripe_t& stripe_of(uint64_t addr){
+        uint64_t h = addr;
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+        return stripes_[(h ^ (h >> 31)) & mask_];
+    }
+
+public:
+    /// @brief Create the cohorts
+    /// @param stripes the number of cohorts. Rounded down to a power of two. 0 disables cohorting
+    LockCohort(size_t stripes){
+        size_t count = 1;
+        while (count * 2 <= stripes) count *= 2;
+        mask_ = count - 1;
+        if (stripes != 0) stripes_ = std::make_unique<stripe_t[]>(count);
+    }
+
+    bool enabled() const {
+        return stripes_ != nullptr;
+    }
+
+    /// @brief Join the cohort of a remote lock, waiting for the cohort's local lock. Must be followed by pass or leave
+    /// @param addr the packed pointer to the remote lock
+    /// @return the remote lock the cohort kept held. If it is addr, the caller holds the remote lock already.
+    /// If it is another, the caller must release it before taking addr
+    held_t enter(uint64_t addr){
+        stripe_t& s = stripe_of(addr);
+        s.waiting.fetch_add(1, std::memory_order_relaxed);
+        s.lock.lock();
+        s.waiting.fetch_sub(1, std::memory_order_relaxed);
+        held_t held = s.held;
+        s.held = held_t();
+        if (held.addr != addr) s.passes = 0;
+        return held;
+    }
+
+    /// @brief Pass a remote lock we hold to the next thread of the cohort, if one is waiting. Leaves the cohort if it did
+    /// @param addr the packed pointer to the remote lock
+    /// @param value what the remote lock should be after unlocking
+    /// @return if the lock was passed on. If not, the caller still holds the cohort, and must release the remote lock and then leave
+    bool pass(uint64_t addr, uint64_t value){
+        stripe_t& s = stripe_of(addr);
+        if (s.passes >= CNF_COHORT_PASSES || s.waiting.load(std::memory_order_relaxed) == 0) return false;
+        s.held = held_t{addr, value};
+        s.passes++;
+        s.lock.unlock();
+        return true;
+    }
+
+    /// @brief Leave the cohort of a remote lock, once the remote lock is released (or wasn't taken)
+    void leave(uint64_t addr){
+        stripe_t& s = stripe_of(addr);
+        s.passes = 0;
+        s.lock.unlock();
+    }
+};
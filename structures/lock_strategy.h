@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "common.h"
+
+/// @brief Parse the name of a lock strategy, as given to the experiment
+/// @param name one of spin, ttas, backoff or ticket
+/// @param out set to the strategy if the name is known
+/// @return if the name is known
+inline bool parse_lock_strategy(const std::string& name, LockStrategy& out){
+    if (name == "spin") out = LockStrategy::SPIN;
+    else if (name == "ttas") out = LockStrategy::TTAS;
+    else if (name == "backoff") out = LockStrategy::BACKOFF;
+    else if (name == "ticket") out = LockStrategy::TICKET;
+    else return false;
+    return true;
+}
+
+/// @brief One acquisition of a remote lock. Decides how to wait between attempts, and records how many it took.
+/// The structure does the attempts itself, since each encodes its lock differently
+class LockWaiter {
+public:
+    /// @param strategy how to wait
+    /// @param stats where to record the acquisition. Can be nullptr
+    LockWaiter(LockStrategy strategy, LockStats* stats) : strategy_(strategy), stats_(stats), limit_ns_(CNF_BACKOFF_MIN_NS) {
+        seed_ = std::chrono::steady_clock::now().time_since_epoch().count() ^ reinterpret_cast<uintptr_t>(this);
+    }
+
+    /// @brief If the lock should be read until it looks free before each CAS
+    bool test_first() const {
+        return strategy_ == LockStrategy::TTAS;
+    }
+
+    /// @brief Count a failed attempt (or a poll of a held lock)
+    /// @param held if the lock was held by someone else. A copy of the lock that was only stale is retried right away
+    void retry(bool held){
+        retries_++;
+        if (!held || strategy_ == LockStrategy::SPIN || strategy_ == LockStrategy::TTAS) return;
+        // A random wait up to the limit, so the threads that collided don't collide again. The limit doubles up to CNF_BACKOFF_MAX_NS
+        seed_ ^= seed_ << 13;
+        seed_ ^= seed_ >> 7;
+        seed_ ^= seed_ << 17;
+        uint64_t wait_ns = limit_ns_ / 2 + seed_ % (limit_ns_ / 2 + 1);
+        if (limit_ns_ < CNF_BACKOFF_MAX_NS) limit_ns_ *= 2;
+        auto until = std::chrono::steady_clock::now() + std::chrono::nanoseconds(wait_ns);
+        while (std::chrono::steady_clock::now() < until);
+    }
+
+    /// @brief Record the acquisition, once the lock is held
+    void acquired(){
+        if (stats_ != nullptr) stats_->record(retries_);
+    }
+
+private:
+    LockStrategy strategy_;
+    LockStats* stats_;
+    uint64_t retries_ = 0;
+    uint64_t limit_ns_; // The longest the next backoff can be
+    uint64_t seed_; // State of the xorshift that randomizes the backoff
+};
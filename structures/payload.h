@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+/// @brief How a key or value is turned into bytes when it is stored out of line. The default copies the object, which is right for any trivially copyable type.
+/// Specialize it for a type that owns memory (like std::string), to store what it owns instead.
+template <typename T>
+struct PayloadCodec {
+    static_assert(std::is_trivially_copyable_v<T>, "PayloadCodec must be specialized for types that aren't trivially copyable");
+
+    /// @brief The number of bytes v is encoded in
+    static size_t size(const T&){
+        return sizeof(T);
+    }
+
+    /// @brief Encode v into out, which has room for size(v) bytes
+    static void encode(const T& v, uint8_t* out){
+        memcpy(out, &v, sizeof(T));
+    }
+
+    /// @brief The reverse of encode
+    static T decode(const uint8_t* in, size_t){
+        T v;
+        memcpy(&v, in, sizeof(T));
+        return v;
+    }
+};
+
+template <>
+struct PayloadCodec<std::string> {
+    static size_t size(const std::string& v){
+        return v.size();
+    }
+
+    static void encode(const std::string& v, uint8_t* out){
+        memcpy(out, v.data(), v.size());
+    }
+
+    static std::string decode(const uint8_t* in, size_t len){
+        return std::string(reinterpret_cast<const char*>(in), len);
+    }
+};
+
+/// @brief If a key and value pair is small enough to be stored in the EList itself. Anything else is stored in a payload of its own, which the EList points to
+template <typename K, typename V>
+constexpr bool stored_inline = std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V> && sizeof(K) + sizeof(V) <= 16;
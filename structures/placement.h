@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "common.h"
+
+/// @brief Parse the name of a placement policy, as given to the experiment
+/// @param name one of local, round_robin, hash_home or least_loaded
+/// @param out set to the policy if the name is known
+/// @return if the name is known
+inline bool parse_placement(const std::string& name, Placement& out){
+    if (name == "local") out = Placement::LOCAL;
+    else if (name == "round_robin") out = Placement::ROUND_ROBIN;
+    else if (name == "hash_home") out = Placement::HASH_HOME;
+    else if (name == "least_loaded") out = Placement::LEAST_LOADED;
+    else return false;
+    return true;
+}
+
+/// @brief The objects a peer keeps ready for other peers to place in its pool, since a peer can only allocate from its own.
+/// It lives in the peer's pool. Another peer takes an object by CAS-ing its slot to 0, and the peer refills the empty slots.
+/// An object comes back to its owner like any other once it is retired
+struct alignas(64) PlacementStock {
+    // Objects are kept by size: elists, then plists of 1, 2, 4, ... times PLIST_SIZE buckets
+    static const int CLASSES = 1 + CNF_STOCK_PLISTS;
+
+    /// @brief One size of object
+    struct row_t {
+        uint64_t slots[CNF_STOCK_SIZE]; // Packed pointers to the objects. 0 if taken
+    };
+
+    uint64_t used; // Bytes of table the peer has handed out, to itself or from its stock. Only the peer writes it. Memory freed since isn't taken off
+    row_t rows[CLASSES];
+};
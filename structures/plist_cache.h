@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "rome/rdma/memory_pool/memory_pool.h"
+#include "common.h"
+
+using ::rome::rdma::remote_nullptr;
+using ::rome::rdma::remote_ptr;
+
+/// @brief A node-wide cache of sub-PList pointers, shared by all the threads of a node.
+/// Maps (parent plist, bucket) to the plist the bucket points to. Without compaction that pointer never changes, so entries never go stale.
+/// Compaction can fold the sub-plist back into the bucket. An entry for it then leads to FOLDED buckets, which send the operation back to the root,
+/// and entries carry the reclamation epoch they were made in, so a lookup only trusts the ones recent enough that the plist can't have been freed since.
+/// The cache is direct-mapped: an insert overwrites whatever is in its slot, which bounds the memory used.
+class PListCache {
+private:
+    // A slot is guarded by a sequence lock. An odd sequence number means a write is in progress
+    struct alignas(64) slot_t {
+        std::atomic<uint64_t> seq{0};
+        std::atomic<uint64_t> parent{0};
+        std::atomic<uint64_t> bucket{0};
+        std::atomic<uint64_t> child{0};
+        std::atomic<uint64_t> epoch{0}; // The epoch the entry was made in. 0 without compaction
+    };
+
+    size_t mask_;
+    std::unique_ptr<slot_t[]> slots_;
+
+    // splitmix64 finalizer, to spread the plist addresses (which are 64 byte aligned) across the slots
+    inline size_t slot_of(uint64_t parent, uint64_t bucket){
+        uint64_t h = parent ^ (bucket * 0x9e3779b97f4a7c15ull);
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+        return (h ^ (h >> 31)) & mask_;
+    }
+
+public:
+    /// @brief Create a cache
+    /// @param capacity the maximum number of entries. Rounded down to a power of two. 0 disables the cache
+    PListCache(size_t capacity){
+        size_t slots = 1;
+        while (slots * 2 <= capacity) slots *= 2;
+        mask_ = slots - 1;
+        if (capacity != 0) slots_ = std::make_unique<slot_t[]>(slots);
+    }
+
+    bool enabled() const {
+        return slots_ != nullptr;
+    }
+
+    /// @brief Find the sub-plist a bucket points to
+    /// @param parent the plist that holds the bucket
+    /// @param bucket the index of the bucket in parent
+    /// @param min_epoch the oldest epoch of an entry that is trusted
+    /// @return the sub-plist, or remote_nullptr if it isn't cached
+    template <typename T>
+    remote_ptr<T> lookup(remote_ptr<T> parent, uint64_t bucket, uint64_t min_epoch = 0){
+        if (!enabled()) return remote_nullptr;
+        uint64_t p = pack_ptr(parent);
+        slot_t& slot = slots_[slot_of(p, bucket)];
+        uint64_t before = slot.seq.load(std::memory_order_acquire);
+        if (before & 1) return remote_nullptr;
+        uint64_t slot_parent = slot.parent.load(std::memory_order_relaxed);
+        uint64_t slot_bucket = slot.bucket.load(std::memory_order_relaxed);
+        uint64_t slot_child = slot.child.load(std::memory_order_relaxed);
+        uint64_t slot_epoch = slot.epoch.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != before) return remote_nullptr;
+        if (slot_child == 0 || slot_parent != p || slot_bucket != bucket || slot_epoch < min_epoch) return remote_nullptr;
+        return unpack_ptr<T>(slot_child);
+    }
+
+    /// @brief Remember the sub-plist of a permanently unlocked bucket
+    /// @param parent the plist that holds the bucket
+    /// @param bucket the index of the bucket in parent
+    /// @param child the sub-plist the bucket points to
+    /// @param epoch the epoch the bucket was read in
+    template <typename T>
+    void insert(remote_ptr<T> parent, uint64_t bucket, remote_ptr<T> child, uint64_t epoch = 0){
+        if (!enabled()) return;
+        uint64_t p = pack_ptr(parent);
+        slot_t& slot = slots_[slot_of(p, bucket)];
+        uint64_t before = slot.seq.load(std::memory_order_relaxed);
+        // Another thread is writing the slot. It's only a cache, so just give up
+        if ((before & 1) || !slot.seq.compare_exchange_strong(before, before + 1, std::memory_order_acquire)) return;
+        slot.parent.store(p, std::memory_order_relaxed);
+        slot.bucket.store(bucket, std::memory_order_relaxed);
+        slot.child.store(pack_ptr(child), std::memory_order_relaxed);
+        slot.epoch.store(epoch, std::memory_order_relaxed);
+        slot.seq.store(before + 2, std::memory_order_release);
+    }
+
+    /// @brief Forget the sub-plist of a bucket, once it was folded back into the bucket
+    /// @param parent the plist that holds the bucket
+    /// @param bucket the index of the bucket in parent
+    template <typename T>
+    void erase(remote_ptr<T> parent, uint64_t bucket){
+        if (!enabled()) return;
+        uint64_t p = pack_ptr(parent);
+        slot_t& slot = slots_[slot_of(p, bucket)];
+        while (true){
+            uint64_t before = slot.seq.load(std::memory_order_relaxed);
+            if (before & 1) continue; // Unlike an insert, this one can't be dropped
+            if (!slot.seq.compare_exchange_strong(before, before + 1, std::memory_order_acquire)) continue;
+            if (slot.parent.load(std::memory_order_relaxed) == p && slot.bucket.load(std::memory_order_relaxed) == bucket) slot.child.store(0, std::memory_order_relaxed);
+            slot.seq.store(before + 2, std::memory_order_release);
+            return;
+        }
+    }
+};
@@ -0,0 +1,308 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "rome/rdma/memory_pool/memory_pool.h"
+#include "rome/logging/logging.h"
+#include "common.h"
+
+using ::rome::rdma::MemoryPool;
+using ::rome::rdma::remote_nullptr;
+using ::rome::rdma::remote_ptr;
+
+/// @brief Epoch-based reclamation of memory that lock-free readers might still be reading after it is unlinked.
+/// There is one reclaimer per peer (memory pool), shared by the threads that use the pool.
+/// Each thread announces the epoch of its oldest operation in flight, and every so often the peer reports the oldest of those to a table on the host.
+/// The global epoch advances once every peer has reported it, so an object retired in epoch e is unreachable by anyone once the global epoch is e + 2.
+/// The peer that owns the object frees it. Objects of another peer are pushed on the owner's inbox, a stack linked through the dead objects themselves.
+class EpochReclaimer {
+public:
+    static const int MAX_PEERS = 64;
+    static const int MAX_THREADS = 64;
+
+    /// @brief Shared by every peer. Lives on the host
+    struct alignas(64) EpochTable {
+        uint64_t epoch; // The global epoch. Starts at 1
+        uint64_t quiescent[MAX_PEERS]; // The oldest epoch the threads of each peer might be in. 0 if the peer isn't registered
+        uint64_t inboxes[MAX_PEERS]; // Packed pointer to each peer's inbox
+    };
+    typedef remote_ptr<EpochTable> remote_table;
+
+    /// @brief Announces an operation to the reclaimer for as long as it lives. Does nothing if the reclaimer is nullptr
+    class Guard {
+    public:
+        Guard(EpochReclaimer* reclaimer, int slot) : reclaimer_(reclaimer), slot_(slot) {
+            if (reclaimer_ != nullptr) epoch_ = reclaimer_->enter(slot_);
+        }
+        Guard(const Guard&) = delete;
+        ~Guard(){
+            if (reclaimer_ != nullptr) reclaimer_->exit(slot_, epoch_);
+        }
+    private:
+        EpochReclaimer* reclaimer_;
+        int slot_;
+        uint64_t epoch_ = 0;
+    };
+
+private:
+    static const uint64_t IDLE = ~0ull;
+
+    // What is written at the start of an object on its way back to its owner
+    struct shipped_t {
+        uint64_t next; // Packed pointer to the next object of the inbox
+        uint64_t bytes; // Size of the object
+    };
+
+    struct retired_t {
+        uint64_t ptr; // Packed pointer to the object
+        uint64_t bytes; // Size of the object
+        uint64_t epoch; // Epoch it was retired in
+    };
+
+    struct alignas(64) thread_slot_t {
+        std::atomic<uint64_t> announced{IDLE}; // The epoch of the oldest operation this thread has in flight
+        std::atomic<bool> used{false};
+        // Operations in flight are in at most two epochs, because the global epoch waits for the oldest. Indexed by epoch parity
+        uint64_t epochs[2] = {0, 0};
+        uint64_t active[2] = {0, 0};
+        uint64_t since_advance = 0; // Operations since this thread last tried to advance the epoch
+    };
+
+    MemoryPool::Peer self_;
+    MemoryPool* pool_;
+    remote_table table_ = remote_nullptr;
+    remote_ptr<uint64_t> inbox_ = remote_nullptr;
+    std::atomic<uint64_t> local_epoch_{1}; // Our view of the global epoch. Never ahead of it
+    std::mutex attach_lock_;
+    std::mutex advance_lock_; // Only one thread of the peer advances at a time
+    std::mutex retired_lock_;
+    std::vector<retired_t> retired_; // The retire list of the peer
+    thread_slot_t slots_[MAX_THREADS];
+
+    void announce(thread_slot_t& s){
+        uint64_t oldest = IDLE;
+        for (int p = 0; p < 2; p++){
+            if (s.active[p] != 0 && s.epochs[p] < oldest) oldest = s.epochs[p];
+        }
+        s.announced.store(oldest);
+    }
+
+    inline bool is_local(remote_ptr<uint64_t> ptr){
+        return ptr.id() == self_.id;
+    }
+
+    /// @brief Write a word of the table, which might be ours
+    inline void write_word(remote_ptr<uint64_t> ptr, uint64_t value){
+        if (is_local(ptr)){
+            *(volatile uint64_t*) std::to_address(ptr) = value;
+            return;
+        }
+        remote_ptr<uint64_t> temp = pool_->Allocate<uint64_t>();
+        pool_->Write<uint64_t>(ptr, value, temp);
+        // Have to deallocate "8" of them to account for alignment
+        pool_->Deallocate<uint64_t>(temp, 8);
+    }
+
+    inline remote_ptr<uint64_t> table_word(size_t offset){
+        return remote_ptr<uint64_t>(table_.id(), table_.address() + offset);
+    }
+
+    /// @brief Free an object we own, or send it back to its owner
+    /// @return false if the owner has no inbox yet
+    bool release(const retired_t& r, const EpochTable& t){
+        remote_ptr<uint8_t> obj = unpack_ptr<uint8_t>(r.ptr);
+        if (obj.id() == self_.id){
+            pool_->Deallocate<uint8_t>(obj, r.bytes);
+            freed++;
+            return true;
+        }
+        if (obj.id() >= MAX_PEERS || t.inboxes[obj.id()] == 0) return false;
+        remote_ptr<uint64_t> inbox = unpack_ptr<uint64_t>(t.inboxes[obj.id()]);
+        remote_ptr<shipped_t> link = unpack_ptr<shipped_t>(r.ptr);
+        remote_ptr<shipped_t> temp = pool_->Allocate<shipped_t>();
+        uint64_t head = 0;
+        while (true){
+            // Link the object in front of the head we last saw, then try to swing the head to it
+            pool_->Write<shipped_t>(link, shipped_t{head, r.bytes}, temp);
+            uint64_t v = pool_->CompareAndSwap<uint64_t>(inbox, head, r.ptr);
+            if (v == head) break;
+            head = v;
+        }
+        // Have to deallocate "4" of them to account for alignment
+        pool_->Deallocate<shipped_t>(temp, 4);
+        shipped++;
+        return true;
+    }
+
+    /// @brief Free the objects other peers sent back to us
+    void drain_inbox(){
+        uint64_t head = *(volatile uint64_t*) std::to_address(inbox_);
+        while (head != 0){
+            // Others push with RDMA atomics, so we have to take the list with one too
+            uint64_t v = pool_->CompareAndSwap<uint64_t>(inbox_, head, 0);
+            if (v == head) break;
+            head = v;
+        }
+        while (head != 0){
+            shipped_t* s = std::to_address(unpack_ptr<shipped_t>(head));
+            uint64_t next = s->next;
+            pool_->Deallocate<uint8_t>(unpack_ptr<uint8_t>(head), s->bytes);
+            freed++;
+            head = next;
+        }
+    }
+
+public:
+    std::atomic<uint64_t> freed{0}; // Objects freed by this peer
+    std::atomic<uint64_t> shipped{0}; // Objects sent back to their owner
+
+    EpochReclaimer(MemoryPool::Peer self, MemoryPool* pool) : self_(self), pool_(pool) {}
+
+    /// @brief Make the shared table. Done once, by the host
+    static remote_table create_table(MemoryPool* pool){
+        remote_table t = pool->Allocate<EpochTable>();
+        t->epoch = 1;
+        for (int i = 0; i < MAX_PEERS; i++){
+            t->quiescent[i] = 0;
+            t->inboxes[i] = 0;
+        }
+        return t;
+    }
+
+    /// @brief Register the peer with the shared table. Every thread calls this, only the first one does anything
+    void attach(remote_table table){
+        std::lock_guard<std::mutex> guard(attach_lock_);
+        if (table_ != remote_nullptr) return;
+        if (self_.id >= MAX_PEERS){
+            ROME_INFO("Warning: Peer {} is past MAX_PEERS and can't reclaim memory", self_.id);
+            return;
+        }
+        table_ = table;
+        inbox_ = pool_->Allocate<uint64_t>();
+        *std::to_address(inbox_) = 0;
+        // Start from the current epoch
+        remote_ptr<uint64_t> epoch = table_word(offsetof(EpochTable, epoch));
+        uint64_t e = pool_->CompareAndSwap<uint64_t>(epoch, 0, 0);
+        local_epoch_.store(e);
+        write_word(table_word(offsetof(EpochTable, inboxes) + sizeof(uint64_t) * self_.id), pack_ptr(inbox_));
+        write_word(table_word(offsetof(EpochTable, quiescent) + sizeof(uint64_t) * self_.id), e);
+    }
+
+    /// @brief Claim a slot for the calling thread
+    int register_thread(){
+        for (int i = 0; i < MAX_THREADS; i++){
+            bool expected = false;
+            if (slots_[i].used.compare_exchange_strong(expected, true)) return i;
+        }
+        ROME_ASSERT(false, "More than {} threads on one EpochReclaimer", MAX_THREADS);
+        return -1;
+    }
+
+    /// @brief Give back a thread's slot
+    void unregister_thread(int slot){
+        slots_[slot].announced.store(IDLE);
+        slots_[slot].used.store(false);
+    }
+
+    /// @brief Start an operation. Nothing retired from now on is freed until the matching exit
+    /// @return the epoch of the operation, to pass to exit
+    uint64_t enter(int slot){
+        thread_slot_t& s = slots_[slot];
+        while (true){
+            uint64_t e = local_epoch_.load();
+            s.epochs[e & 1] = e;
+            s.active[e & 1]++;
+            announce(s);
+            // A thread advancing the epoch might have scanned the slots before we announced. If so, start over in the new epoch
+            if (local_epoch_.load() == e) return e;
+            s.active[e & 1]--;
+            announce(s);
+        }
+    }
+
+    /// @brief Finish an operation. Every so often, try to advance the epoch and free what is safe to
+    void exit(int slot, uint64_t epoch){
+        thread_slot_t& s = slots_[slot];
+        s.active[epoch & 1]--;
+        announce(s);
+        if (++s.since_advance >= CNF_RECLAIM_PERIOD){
+            s.since_advance = 0;
+            try_advance();
+        }
+    }
+
+    /// @brief Our view of the global epoch. An operation that enters now is in it
+    uint64_t epoch(){
+        return local_epoch_.load();
+    }
+
+    /// @brief The epoch of the oldest operation a thread has in flight. An object it found reachable is retired in that epoch or later
+    uint64_t oldest(int slot){
+        return slots_[slot].announced.load();
+    }
+
+    /// @brief Retire an object that was unlinked from the data structure. It is freed once no operation can still be reading it
+    /// @param ptr the object
+    /// @param count how many T it is made of
+    template <typename T>
+    void retire(remote_ptr<T> ptr, size_t count = 1){
+        // Our view might be behind the global epoch by one, so use the newest the global epoch could be
+        retired_t r = {pack_ptr(ptr), sizeof(T) * count, local_epoch_.load() + 1};
+        std::lock_guard<std::mutex> guard(retired_lock_);
+        retired_.push_back(r);
+    }
+
+    /// @brief Report our oldest epoch, advance the global epoch if everyone has caught up with it, then free what is safe to
+    void try_advance(){
+        if (table_ == remote_nullptr) return;
+        std::unique_lock<std::mutex> guard(advance_lock_, std::try_to_lock);
+        if (!guard.owns_lock()) return; // Another thread of ours is on it
+
+        // Idle threads will enter with at least our current view
+        uint64_t view = local_epoch_.load();
+        uint64_t oldest = view;
+        for (int i = 0; i < MAX_THREADS; i++){
+            if (!slots_[i].used.load()) continue;
+            uint64_t a = slots_[i].announced.load();
+            if (a < oldest) oldest = a;
+        }
+        write_word(table_word(offsetof(EpochTable, quiescent) + sizeof(uint64_t) * self_.id), oldest);
+
+        remote_table t = is_local(static_cast<remote_ptr<uint64_t>>(table_)) ? table_ : pool_->Read<EpochTable>(table_);
+        uint64_t g = t->epoch;
+        bool caught_up = true;
+        for (int i = 0; i < MAX_PEERS; i++){
+            if (t->quiescent[i] != 0 && t->quiescent[i] < g) caught_up = false;
+        }
+        if (caught_up){
+            uint64_t v = pool_->CompareAndSwap<uint64_t>(table_word(offsetof(EpochTable, epoch)), g, g + 1);
+            g = v == g ? g + 1 : v;
+        }
+        if (g > view) local_epoch_.store(g);
+
+        // Free (or send back) what was retired at least two epochs ago
+        std::vector<retired_t> ready;
+        {
+            std::lock_guard<std::mutex> retired_guard(retired_lock_);
+            size_t kept = 0;
+            for (size_t i = 0; i < retired_.size(); i++){
+                if (retired_[i].epoch + 2 <= g) ready.push_back(retired_[i]);
+                else retired_[kept++] = retired_[i];
+            }
+            retired_.resize(kept);
+        }
+        std::vector<retired_t> later;
+        for (const retired_t& r : ready){
+            if (!release(r, *std::to_address(t))) later.push_back(r);
+        }
+        if (!later.empty()){
+            std::lock_guard<std::mutex> retired_guard(retired_lock_);
+            retired_.insert(retired_.end(), later.begin(), later.end());
+        }
+        if (!is_local(static_cast<remote_ptr<uint64_t>>(table_))) pool_->Deallocate<EpochTable>(t);
+        drain_inbox();
+    }
+};
@@ -4,5 +4,7 @@
 #include "common.h"
 
 template class RdmaIHT<int, int, CNF_ELIST_SIZE, CNF_PLIST_SIZE>;
+template class RdmaIHT<std::string, std::string, CNF_ELIST_SIZE, CNF_PLIST_SIZE>;
+template class RdmaIHT<int, int, CNF_ELIST_SIZE, CNF_PLIST_SIZE, MixedLevelHash<int>, 2>;
 template class Hashtable<int, int, CNF_PLIST_SIZE>;
 template class LinkedSet<int, int>;
\ No newline at end of file